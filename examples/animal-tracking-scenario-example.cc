@@ -22,6 +22,9 @@
 #include "ns3/lora-net-device.h"
 #include "ns3/lora-channel.h"
 #include "ns3/ascii-helper-for-lora.h"
+#include "ns3/lora-phy-helper.h"
+#include "ns3/lora-mac-helper.h"
+#include "ns3/lora-mesh-helper.h"
 
 #include <iterator>
 
@@ -45,6 +48,20 @@ main(int argc, char *argv[])
     LogComponentEnable("LoRaPHY", LOG_LEVEL_ALL);
     NS_LOG_UNCOND ("LoRa Mesh Animal Tracking Scenario Example...");
     
+    //defaults may be overridden from the command line
+    Config::SetDefault("ns3::LoRaPHY::TxPower", DoubleValue(20));    //dBm
+    Config::SetDefault("ns3::LoRaPHY::RxFreq", DoubleValue(860));    //MHz
+    Config::SetDefault("ns3::LoRaPHY::TxFreq", DoubleValue(860));    //MHz
+    Config::SetDefault("ns3::LoRaPHY::TxSF", UintegerValue(SIMULATION_SF));
+    Config::SetDefault("ns3::LoRaPHY::RxSF", UintegerValue(SIMULATION_SF));
+    Config::SetDefault("ns3::LoRaPHY::HeaderDisabled", BooleanValue(true));    //implicit header required for SF6
+    Config::SetDefault("ns3::LoRaPHY::TxBW", DoubleValue(125000));   //Hz
+    Config::SetDefault("ns3::LoRaMAC::MinDelay", UintegerValue(0));
+    Config::SetDefault("ns3::LoRaMAC::MaxDelay", UintegerValue(NUM_NODES*5));
+    
+    CommandLine cmd;
+    cmd.Parse(argc, argv);
+    
     //create channel
     Ptr<LoRaChannel> channel = CreateObject<LoRaChannel>();
     
@@ -80,80 +97,20 @@ main(int argc, char *argv[])
     mobility.Install(loranodes);
     mobility_centre.Install(centre);
     
-    //create phys for nodes
-    //create macs for nodes
-    //create devices for nodes
-    //attach devices, phys and macs
-    //add phys to channel
+    //create phys, macs and devices for nodes and add phys to channel
+    LoRaPhyHelper phyHelper;
+    LoRaMacHelper macHelper;
+    LoRaMeshHelper meshHelper;
     
-    Ptr<LoRaNetDevice> device;
-    Ptr<LoRaPHY> phy;
-    Ptr<LoRaMAC> mac;
+    phyHelper.SetChannel(channel);
     
-    for (NodeContainer::Iterator i = loranodes.Begin(); i != loranodes.End(); ++i)
-    {
-        Ptr<Node> node = *i;
-        device = Create<LoRaNetDevice>();
-        phy = CreateObject<LoRaPHY>();
-        mac = CreateObject<LoRaMAC>();
-        
-        phy->SetChannel(channel);
-        phy->SetNetDevice(device);
-        phy->SetMAC(mac);
-
-        //sx1278
-        phy->SetRxSens(sx1278_RxSens[SIMULATION_SF - 6]); //dBm
-        phy->SetTxPower(20);    //dBm
-        phy->SetRxFreq(860);    //MHz
-        phy->SetTxFreq(860);    //MHz
-        phy->SetTxSF(SIMULATION_SF);    
-        phy->SetRxSF(SIMULATION_SF);
-        phy->SetTxBW(125000);   //Hz
-
-        channel->AddPHY(phy);
-        device->SetMAC(mac);
-        device->SetPHY(phy);
-        device->SetNode(node);
-        node->AddDevice(device);
-        mac->SetMinDelay(0);
-        mac->SetMaxDelay(NUM_NODES*5);
-        mac->SetPHY(phy);
-        mac->SetDevice(device);
-    }
+    //sx1278
+    phyHelper.Set("RxSens", DoubleValue(sx1278_RxSens[SIMULATION_SF - 6])); //dBm
+    meshHelper.Install(phyHelper, macHelper, loranodes);
     
-    for (NodeContainer::Iterator i = centre.Begin(); i != centre.End(); ++i)
-    {
-        Ptr<Node> node = *i;
-        device = Create<LoRaNetDevice>();
-        phy = CreateObject<LoRaPHY>();
-        mac = CreateObject<LoRaMAC>();
-        
-        phy->SetChannel(channel);
-        phy->SetNetDevice(device);
-        phy->SetMAC(mac);
-        //sx1272
-        phy->SetRxSens(sx1272_RxSens[SIMULATION_SF - 6]); //dBm
-        phy->SetTxPower(20);    //dBm
-        phy->SetRxFreq(860);    //MHz
-        phy->SetTxFreq(860);    //MHz
-        phy->SetTxSF(SIMULATION_SF);    
-        phy->SetRxSF(SIMULATION_SF);
-        phy->SetTxBW(125000);   //Hz
-        
-        channel->AddPHY(phy);
-        
-        device->SetMAC(mac);
-        device->SetPHY(phy);
-        device->SetNode(node);
-        
-        node->AddDevice(device);
-        //device params
-        
-        mac->SetMinDelay(0);
-        mac->SetMaxDelay(NUM_NODES*5);
-        mac->SetPHY(phy);
-        mac->SetDevice(device);
-    }
+    //sx1272
+    phyHelper.Set("RxSens", DoubleValue(sx1272_RxSens[SIMULATION_SF - 6])); //dBm
+    meshHelper.Install(phyHelper, macHelper, centre);
     
     //install applications
     ApplicationContainer apps;
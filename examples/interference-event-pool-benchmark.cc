@@ -0,0 +1,95 @@
+#include "ns3/core-module.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+
+#include "ns3/lora-interference-helper.h"
+
+#include <chrono>
+#include <deque>
+#include <vector>
+
+using namespace ns3;
+using namespace lora_mesh;
+
+NS_LOG_COMPONENT_DEFINE ("InterferenceEventPoolBenchmark");
+
+/*
+ *  Microbenchmark of the LoraInterferenceHelper::Event allocation path.
+ *
+ *  Every transmission creates one event at each of the other nodes, and each node keeps its
+ *  most recent events alive as it would while they may still overlap a reception. The same
+ *  workload is run with the event pool disabled (every event on the heap on its own) and
+ *  enabled, reporting the time per event and how far the pool had to grow.
+ */
+
+static double
+RunWorkload (uint32_t n_nodes, uint32_t n_tx, uint32_t n_live)
+{
+    Ptr<Packet> packet = Create<Packet> (25);
+    std::vector<std::deque<Ptr<LoraInterferenceHelper::Event>>> events (n_nodes);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+
+    for (uint32_t tx = 0; tx < n_tx; tx++)
+    {
+        uint32_t sender = tx % n_nodes;
+
+        for (uint32_t rx = 0; rx < n_nodes; rx++)
+        {
+            if (rx == sender)
+            {
+                continue;
+            }
+
+            events[rx].push_back (Create<LoraInterferenceHelper::Event> (MilliSeconds (tx), MilliSeconds (50), -100.0, 7, packet, 868.1));
+
+            /*  the oldest event expires    */
+            if (events[rx].size () > n_live)
+            {
+                events[rx].pop_front ();
+            }
+        }
+    }
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now ();
+
+    /*  release everything so the pool can be toggled for the next run */
+    events.clear ();
+
+    return std::chrono::duration<double, std::nano> (end - start).count () / ((double)n_tx * (n_nodes - 1));
+}
+
+int
+main (int argc, char *argv[])
+{
+    uint32_t n_nodes = 1000;
+    uint32_t n_tx = 10000;
+    uint32_t n_live = 8;
+
+    CommandLine cmd;
+    cmd.AddValue ("nodes", "Number of nodes on the channel", n_nodes);
+    cmd.AddValue ("transmissions", "Number of transmissions to simulate", n_tx);
+    cmd.AddValue ("live", "Number of events each node keeps alive", n_live);
+    cmd.Parse (argc, argv);
+
+    NS_LOG_UNCOND ("LoRa Mesh Interference Event Pool Benchmark..." << std::endl);
+    NS_LOG_UNCOND ("nodes: " << n_nodes << ", transmissions: " << n_tx << ", live events per node: " << n_live);
+
+    LoraInterferenceHelper::Event::SetPoolEnabled (false);
+    double heap_ns = RunWorkload (n_nodes, n_tx, n_live);
+    NS_LOG_UNCOND ("heap:   " << heap_ns << " ns/event");
+
+    LoraInterferenceHelper::Event::SetPoolEnabled (true);
+    double pool_ns = RunWorkload (n_nodes, n_tx, n_live);
+    NS_LOG_UNCOND ("pooled: " << pool_ns << " ns/event (pool capacity " << LoraInterferenceHelper::Event::GetPoolCapacity () << " events)");
+
+    /*  a second pooled run must be served entirely from the pool   */
+    uint32_t capacity = LoraInterferenceHelper::Event::GetPoolCapacity ();
+    pool_ns = RunWorkload (n_nodes, 2 * n_tx, n_live);
+    NS_LOG_UNCOND ("pooled (2x transmissions): " << pool_ns << " ns/event (pool grew by " << LoraInterferenceHelper::Event::GetPoolCapacity () - capacity << " events)");
+
+    Simulator::Destroy ();
+    return 0;
+}
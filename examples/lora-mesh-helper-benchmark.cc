@@ -0,0 +1,105 @@
+#include "ns3/core-module.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include "ns3/ptr.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/mobility-helper.h"
+
+#include "ns3/lora-channel.h"
+#include "ns3/lora-phy-helper.h"
+#include "ns3/lora-mac-helper.h"
+#include "ns3/lora-mesh-helper.h"
+
+#include <chrono>
+#include <cmath>
+
+using namespace ns3;
+using namespace lora_mesh;
+
+NS_LOG_COMPONENT_DEFINE ("LoRaMeshHelperBenchmark");
+
+/*
+ *  Times the setup of a large scenario with LoRaMeshHelper, which attaches all of the LoRaPHYs
+ *  to the channel in one sorted merge. With "legacy" the devices are wired by hand and attached
+ *  one at a time with LoRaChannel::AddPHY, as the scenario examples used to do.
+ */
+
+static void
+InstallLegacy (Ptr<LoRaChannel> channel, NodeContainer nodes)
+{
+    for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+        Ptr<Node> node = *i;
+        Ptr<LoRaNetDevice> device = CreateObject<LoRaNetDevice> ();
+        Ptr<LoRaPHY> phy = CreateObject<LoRaPHY> ();
+        Ptr<LoRaMAC> mac = CreateObject<LoRaMAC> ();
+
+        phy->SetChannel (channel);
+        phy->SetNetDevice (device);
+        phy->SetMAC (mac);
+
+        channel->AddPHY (phy);
+        device->SetMAC (mac);
+        device->SetPHY (phy);
+        device->SetNode (node);
+        node->AddDevice (device);
+        mac->SetPHY (phy);
+        mac->SetDevice (device);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+    uint32_t n_nodes = 50000;
+    bool legacy = false;
+
+    CommandLine cmd;
+    cmd.AddValue ("nodes", "Number of nodes to install", n_nodes);
+    cmd.AddValue ("legacy", "Attach the LoRaPHYs one at a time instead of using LoRaMeshHelper", legacy);
+    cmd.Parse (argc, argv);
+
+    NS_LOG_UNCOND ("LoRa Mesh Helper Benchmark..." << std::endl);
+
+    Ptr<LoRaChannel> channel = CreateObject<LoRaChannel> ();
+    NodeContainer nodes;
+    nodes.Create (n_nodes);
+
+    MobilityHelper mobility;
+    mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+    mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                   "MinX", DoubleValue (0.0),
+                                   "MinY", DoubleValue (0.0),
+                                   "DeltaX", DoubleValue (100.0),
+                                   "DeltaY", DoubleValue (100.0),
+                                   "GridWidth", UintegerValue ((uint32_t)std::ceil (std::sqrt ((double)n_nodes))),
+                                   "LayoutType", StringValue ("RowFirst"));
+    mobility.Install (nodes);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+
+    if (legacy)
+    {
+        InstallLegacy (channel, nodes);
+    }
+    else
+    {
+        LoRaPhyHelper phy;
+        LoRaMacHelper mac;
+        LoRaMeshHelper helper;
+
+        phy.SetChannel (channel);
+
+        NetDeviceContainer devices = helper.Install (phy, mac, nodes);
+        helper.AssignStreams (devices, 0);
+    }
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now ();
+
+    NS_LOG_UNCOND ((legacy ? "legacy" : "helper") << ": " << channel->GetNDevices () << " devices installed in "
+                   << std::chrono::duration<double> (end - start).count () << " s");
+
+    Simulator::Destroy ();
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include "ns3/core-module.h"
+#include "ns3/log.h"
+
+#include "ns3/lora-trace-record.h"
+#include "ns3/async-trace-writer.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace ns3;
+using namespace lora_mesh;
+
+NS_LOG_COMPONENT_DEFINE ("LoRaTraceConverter");
+
+/*
+ *  Offline converter for the binary traces written by BinaryTraceHelperForLoRa.
+ *
+ *  "text" reproduces the per packet blocks written by AsciiHelperForLoRa (the packet contents
+ *  are not recorded, so only the payload size is shown as data), "csv" writes one row per
+ *  record.
+ *
+ *  ./waf --run "lora-trace-converter --input=trace.bin --format=csv --output=trace.csv"
+ */
+
+int
+main (int argc, char *argv[])
+{
+    std::string input = "trace.bin";
+    std::string output = "";
+    std::string format = "text";
+    
+    CommandLine cmd;
+    cmd.AddValue ("input", "Binary trace written by BinaryTraceHelperForLoRa", input);
+    cmd.AddValue ("output", "File to write to (standard output if empty)", output);
+    cmd.AddValue ("format", "Output format: text or csv", format);
+    cmd.Parse (argc, argv);
+    
+    NS_ABORT_MSG_UNLESS (format == "text" || format == "csv", "Unknown format " << format);
+    
+    std::ifstream in (input.c_str(), std::ios::in | std::ios::binary);
+    NS_ABORT_MSG_UNLESS (in.is_open(), "Unable to open " << input);
+    
+    LoRaTraceFileHeader header;
+    in.read (reinterpret_cast<char *>(&header), sizeof(header));
+    
+    NS_ABORT_MSG_UNLESS (in && header.magic == LORA_TRACE_MAGIC, input << " is not a lora-mesh binary trace");
+    NS_ABORT_MSG_UNLESS (header.version == LORA_TRACE_VERSION && header.record_size == sizeof(LoRaTraceRecord), "Unsupported trace version " << header.version);
+    
+    std::ofstream file;
+    std::ostream *os = &std::cout;
+    
+    if (!output.empty())
+    {
+        file.open (output.c_str());
+        NS_ABORT_MSG_UNLESS (file.is_open(), "Unable to open " << output);
+        os = &file;
+    }
+    
+    if (format == "csv")
+    {
+        AsyncTraceWriter::WriteCsvHeader (*os);
+    }
+    
+    LoRaTraceRecord record;
+    uint64_t count = 0;
+    
+    while (in.read (reinterpret_cast<char *>(&record), sizeof(record)))
+    {
+        if (format == "csv")
+        {
+            AsyncTraceWriter::WriteCsv (*os, record);
+        }
+        else
+        {
+            AsyncTraceWriter::WriteText (*os, record);
+        }
+        
+        count++;
+    }
+    
+    os->flush ();
+    std::cerr << "Converted " << count << " records" << std::endl;
+    
+    return 0;
+}
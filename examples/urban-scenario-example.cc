@@ -22,6 +22,9 @@
 #include "ns3/lora-net-device.h"
 #include "ns3/lora-channel.h"
 #include "ns3/ascii-helper-for-lora.h"
+#include "ns3/lora-phy-helper.h"
+#include "ns3/lora-mac-helper.h"
+#include "ns3/lora-mesh-helper.h"
 #include "ns3/building-penetration-loss.h"
 
 #include <iterator>
@@ -46,6 +49,21 @@ main (int argc, char *argv[])
     LogComponentEnable("LoRaPHY", LOG_LEVEL_ALL);
     NS_LOG_UNCOND ("LoRa Mesh Urban Scenario Example..." << std::endl);
     
+    //sx1278, defaults may be overridden from the command line
+    Config::SetDefault("ns3::LoRaPHY::RxSens", DoubleValue(sx1278_RxSens[SIMULATION_SF - 6]));    //dBm
+    Config::SetDefault("ns3::LoRaPHY::TxPower", DoubleValue(20));    //dBm
+    Config::SetDefault("ns3::LoRaPHY::RxFreq", DoubleValue(860));    //MHz
+    Config::SetDefault("ns3::LoRaPHY::TxFreq", DoubleValue(860));    //MHz
+    Config::SetDefault("ns3::LoRaPHY::TxSF", UintegerValue(SIMULATION_SF));
+    Config::SetDefault("ns3::LoRaPHY::RxSF", UintegerValue(SIMULATION_SF));
+    Config::SetDefault("ns3::LoRaPHY::TxBW", DoubleValue(125000));   //Hz
+    Config::SetDefault("ns3::LoRaMAC::MinDelay", UintegerValue(0));
+    Config::SetDefault("ns3::LoRaMAC::MaxDelay", UintegerValue(20));
+    Config::SetDefault("ns3::LoRaMAC::RoutingUpdateFrequency", UintegerValue(2));
+    
+    CommandLine cmd;
+    cmd.Parse(argc, argv);
+    
     //create channel
     Ptr<LoRaChannel> channel = CreateObject<LoRaChannel>();
     
@@ -147,40 +165,12 @@ main (int argc, char *argv[])
     mobility.Install(loranodes);
     BuildingsHelper::Install(loranodes);
     
-    Ptr<LoRaNetDevice> device;
-    Ptr<LoRaPHY> phy;
-    Ptr<LoRaMAC> mac;
+    LoRaPhyHelper phyHelper;
+    LoRaMacHelper macHelper;
+    LoRaMeshHelper meshHelper;
     
-    for (NodeContainer::Iterator i = loranodes.Begin(); i != loranodes.End(); ++i)
-    {
-        Ptr<Node> node = *i;
-        device = Create<LoRaNetDevice>();
-        phy = CreateObject<LoRaPHY>();
-        mac = CreateObject<LoRaMAC>();
-        
-        phy->SetChannel(channel);
-        phy->SetNetDevice(device);
-        phy->SetMAC(mac);
-        //sx1278
-        phy->SetRxSens(sx1278_RxSens[SIMULATION_SF - 6]); //dBm
-        phy->SetTxPower(20);    //dBm
-        phy->SetRxFreq(860);    //MHz
-        phy->SetTxFreq(860);    //MHz
-        phy->SetTxSF(SIMULATION_SF);    
-        phy->SetRxSF(SIMULATION_SF);
-        phy->SetTxBW(125000);   //Hz
-        
-        channel->AddPHY(phy);
-        device->SetMAC(mac);
-        device->SetPHY(phy);
-        device->SetNode(node);
-        node->AddDevice(device);        
-        mac->SetMinDelay(0);
-        mac->SetMaxDelay(20);
-        mac->SetRoutingUpdateFrequency(2);
-        mac->SetPHY(phy);
-        mac->SetDevice(device);
-    }
+    phyHelper.SetChannel(channel);
+    meshHelper.Install(phyHelper, macHelper, loranodes);
     
     ApplicationContainer apps;
     
@@ -194,6 +184,7 @@ main (int argc, char *argv[])
         apps.Add(app);
     }
     
+    loranodes.Get(6)->GetDevice(0)->GetObject<LoRaNetDevice>()->GetPHY()->SetAttribute("LazyInterference", BooleanValue(true));
     loranodes.Get(6)->GetDevice(0)->GetObject<LoRaNetDevice>()->GetPHY()->SwitchStateSLEEP();    //node 6 was missing in scaenario
     
     //set node locations
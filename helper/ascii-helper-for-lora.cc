@@ -20,6 +20,8 @@
 
 #include "ns3/ascii-helper-for-lora.h"
 
+#include <algorithm>
+
 namespace ns3 {
 namespace lora_mesh {
     
@@ -137,45 +139,76 @@ AsciiHelperForLoRa::AsciiTxSniffer(AsciiHelperForLoRa *ascii, Ptr<OutputStreamWr
 void
 AsciiHelperForLoRa::IncrementSent(Ptr<Packet> packet)
 {
+    LoRaMeshHeader header;
+    
+    packet->PeekHeader(header);
+    
     m_sent++;
-    m_sent_ids.push_back(packet->GetUid());
+    m_flows[std::make_pair(header.GetSrc(), header.GetDest())].sent++;
+    MarkId(m_sent_ids, packet->GetUid());
     return;
 }
 
 void
 AsciiHelperForLoRa::IncrementReceived(Ptr<Packet> packet)
 {
+    LoRaMeshHeader header;
+    
+    packet->PeekHeader(header);
+    
     m_received++;
-    m_received_ids.push_back(packet->GetUid());
+    m_flows[std::make_pair(header.GetSrc(), header.GetDest())].received++;
+    MarkId(m_received_ids, packet->GetUid());
     return;
 }
 
 bool
 AsciiHelperForLoRa::PreviouslySent(uint32_t pid)
 {
-    for (unsigned int i = 0;i < m_sent_ids.size();i++)
-    {
-        if (m_sent_ids[i] == pid)
-        {
-            return true;
-        }
-    }
-    
-    return false;
+    return IsIdMarked(m_sent_ids, pid);
 }
 
 bool
 AsciiHelperForLoRa::PreviouslyReceived(uint32_t pid)
 {
-    for (unsigned int i = 0;i < m_received_ids.size();i++)
+    return IsIdMarked(m_received_ids, pid);
+}
+
+uint64_t
+AsciiHelperForLoRa::GetFlowSent(uint32_t src, uint32_t dest) const
+{
+    std::map<std::pair<uint32_t, uint32_t>, FlowCounter>::const_iterator it = m_flows.find(std::make_pair(src, dest));
+    
+    return (it == m_flows.end()) ? 0 : it->second.sent;
+}
+
+uint64_t
+AsciiHelperForLoRa::GetFlowReceived(uint32_t src, uint32_t dest) const
+{
+    std::map<std::pair<uint32_t, uint32_t>, FlowCounter>::const_iterator it = m_flows.find(std::make_pair(src, dest));
+    
+    return (it == m_flows.end()) ? 0 : it->second.received;
+}
+
+bool
+AsciiHelperForLoRa::MarkId(std::vector<bool> &ids, uint32_t pid)
+{
+    if (pid >= ids.size())
     {
-        if (m_received_ids[i] == pid)
-        {
-            return true;
-        }
+        /*  grow geometrically so marking stays amortised constant time */
+        ids.resize(std::max<size_t>(pid + 1, 2 * ids.size()), false);
     }
     
-    return false;
+    bool marked = ids[pid];
+    ids[pid] = true;
+    
+    return marked;
+}
+
+bool
+AsciiHelperForLoRa::IsIdMarked(const std::vector<bool> &ids, uint32_t pid)
+{
+    return pid < ids.size() && ids[pid];
 }
  
 void
@@ -192,6 +225,14 @@ AsciiHelperForLoRa::DisplayPDR(void)
     *os << "Total Packets Received = " << m_received << std::endl;
     *os << "Calculated PDR = " << pdr << std::endl;
     
+    std::map<std::pair<uint32_t, uint32_t>, FlowCounter>::iterator it = m_flows.begin();
+    
+    for (;it != m_flows.end();++it)
+    {
+        *os << "Flow " << it->first.first << "->" << it->first.second << ": Sent = " << it->second.sent << ", Received = " << it->second.received;
+        *os << ", PDR = " << ((it->second.sent == 0) ? 0 : ((double)it->second.received)/it->second.sent) << std::endl;
+    }
+    
     return;
 }
  
@@ -32,6 +32,8 @@
 #include "ns3/lora-mac.h"
 
 #include <vector>
+#include <map>
+#include <utility>
 
 namespace ns3 {
 namespace lora_mesh {
@@ -48,6 +50,26 @@ public:
     void IncrementReceived(Ptr<Packet> packet);
     bool PreviouslySent(uint32_t pid);
     bool PreviouslyReceived(uint32_t pid);
+    
+    /**
+     *  Gets the number of distinct packets sent from a source to a destination
+     * 
+     *  \param  src     source Node ID of the flow
+     *  \param  dest    destination Node ID of the flow
+     * 
+     *  \return the number of packets sent on the flow
+     */
+    uint64_t GetFlowSent(uint32_t src, uint32_t dest) const;
+    
+    /**
+     *  Gets the number of distinct packets from a source which reached their destination
+     * 
+     *  \param  src     source Node ID of the flow
+     *  \param  dest    destination Node ID of the flow
+     * 
+     *  \return the number of packets received on the flow
+     */
+    uint64_t GetFlowReceived(uint32_t src, uint32_t dest) const;
 private:
     static void AsciiRxSniffer(AsciiHelperForLoRa *ascii, Ptr<OutputStreamWrapper> stream, Ptr<LoRaNetDevice> device, Ptr<Packet> packet);
     static void AsciiTxSniffer(AsciiHelperForLoRa *ascii, Ptr<OutputStreamWrapper> stream, Ptr<LoRaNetDevice> device, Ptr<Packet> packet);
@@ -55,10 +77,26 @@ private:
     void DisplayPDR(void);
     //
     
+    /*  marks a packet ID in a bitmap, returning whether it was already marked  */
+    static bool MarkId(std::vector<bool> &ids, uint32_t pid);
+    static bool IsIdMarked(const std::vector<bool> &ids, uint32_t pid);
+    
+    /*  packet counts for one source and destination pair   */
+    struct FlowCounter
+    {
+        uint64_t sent;
+        uint64_t received;
+    };
+    
     uint64_t m_sent;
     uint64_t m_received;
-    std::vector<uint32_t> m_sent_ids;
-    std::vector<uint32_t> m_received_ids;
+    
+    /*  packet IDs are handed out sequentially so sent and received packets are kept as bitmaps
+        indexed by packet ID    */
+    std::vector<bool> m_sent_ids;
+    std::vector<bool> m_received_ids;
+    
+    std::map<std::pair<uint32_t, uint32_t>, FlowCounter> m_flows;
 };
     
 }
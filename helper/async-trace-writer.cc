@@ -0,0 +1,251 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 Sanjay Charran
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sanjay Charran <sanjaycharran@gmail.com>
+ */
+
+#include "ns3/async-trace-writer.h"
+#include "ns3/abort.h"
+
+#include <chrono>
+#include <cmath>
+
+namespace ns3 {
+namespace lora_mesh {
+
+const uint32_t AsyncTraceWriter::IDLE_US;
+
+AsyncTraceWriter::AsyncTraceWriter(std::string filename, Format format, uint32_t capacity)
+    : m_format(format),
+      m_head(0),
+      m_tail(0),
+      m_flushRequests(0),
+      m_flushesDone(0),
+      m_running(true),
+      m_stalls(0)
+{
+    uint64_t size = 1;
+    
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+    
+    m_ring.resize(size);
+    m_mask = size - 1;
+    
+    m_file.open(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    NS_ABORT_MSG_UNLESS(m_file.is_open(), "Unable to open trace file " << filename);
+    
+    if (m_format == BINARY)
+    {
+        WriteFileHeader(m_file);
+    }
+    else if (m_format == CSV)
+    {
+        WriteCsvHeader(m_file);
+    }
+    
+    m_thread = std::thread(&AsyncTraceWriter::Run, this);
+}
+
+AsyncTraceWriter::~AsyncTraceWriter()
+{
+    Close();
+}
+
+void
+AsyncTraceWriter::Push(const LoRaTraceRecord &record)
+{
+    NS_ABORT_MSG_IF(!m_running.load(std::memory_order_relaxed), "Trace record pushed after the AsyncTraceWriter was closed");
+    
+    uint64_t tail = m_tail.load(std::memory_order_relaxed);
+    
+    if (tail - m_head.load(std::memory_order_acquire) > m_mask)
+    {
+        /*  ring buffer full -- wait for the writer thread  */
+        m_stalls++;
+        
+        while (tail - m_head.load(std::memory_order_acquire) > m_mask)
+        {
+            std::this_thread::yield();
+        }
+    }
+    
+    m_ring[tail & m_mask] = record;
+    m_tail.store(tail + 1, std::memory_order_release);
+    
+    return;
+}
+
+void
+AsyncTraceWriter::Flush(void)
+{
+    if (!m_thread.joinable())
+    {
+        return;
+    }
+    
+    uint64_t request = m_flushRequests.fetch_add(1) + 1;
+    
+    while (m_flushesDone.load(std::memory_order_acquire) < request)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(IDLE_US));
+    }
+    
+    return;
+}
+
+void
+AsyncTraceWriter::Close(void)
+{
+    if (m_thread.joinable())
+    {
+        m_running.store(false, std::memory_order_release);
+        m_thread.join();
+        m_file.close();
+    }
+    
+    return;
+}
+
+uint64_t
+AsyncTraceWriter::GetNStalls(void) const
+{
+    return m_stalls;
+}
+
+void
+AsyncTraceWriter::Run(void)
+{
+    for (;;)
+    {
+        /*  read the requests before the tail so that a flush covers every record pushed
+            before it was requested */
+        uint64_t request = m_flushRequests.load(std::memory_order_acquire);
+        bool running = m_running.load(std::memory_order_acquire);
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        uint64_t tail = m_tail.load(std::memory_order_acquire);
+        
+        for (;head != tail;head++)
+        {
+            Write(m_ring[head & m_mask]);
+            
+            /*  hand back room every so often so the producer does not wait for a whole pass */
+            if ((head & 0xff) == 0xff)
+            {
+                m_head.store(head + 1, std::memory_order_release);
+            }
+        }
+        
+        m_head.store(head, std::memory_order_release);
+        
+        if (request != m_flushesDone.load(std::memory_order_relaxed))
+        {
+            m_file.flush();
+            m_flushesDone.store(request, std::memory_order_release);
+        }
+        
+        if (!running)
+        {
+            break;      /*  everything pushed before stopping has been written  */
+        }
+        
+        if (head == m_tail.load(std::memory_order_acquire))
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(IDLE_US));
+        }
+    }
+    
+    m_file.flush();
+    return;
+}
+
+void
+AsyncTraceWriter::Write(const LoRaTraceRecord &record)
+{
+    switch (m_format)
+    {
+        case BINARY:
+            m_file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+            break;
+        case TEXT:
+            WriteText(m_file, record);
+            break;
+        case CSV:
+            WriteCsv(m_file, record);
+            break;
+    }
+    
+    return;
+}
+
+void
+AsyncTraceWriter::WriteFileHeader(std::ostream &os)
+{
+    LoRaTraceFileHeader header;
+    
+    header.magic = LORA_TRACE_MAGIC;
+    header.version = LORA_TRACE_VERSION;
+    header.record_size = sizeof(LoRaTraceRecord);
+    header.reserved = 0;
+    
+    os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    return;
+}
+
+void
+AsyncTraceWriter::WriteText(std::ostream &os, const LoRaTraceRecord &record)
+{
+    os << (double)record.time_ns << "\tNode #" << record.node << ": " << ((record.event == LORA_TRACE_RX) ? "Received" : "Transmitted") << " Packet #" << record.uid << "\n";
+    os << "\t\tx=" << record.x << " , y=" << record.y << " , z=" << record.z << "\n";
+    os << "\t\tSrc: " << record.src << "\n";
+    os << "\t\tDest: " << record.dest << "\n";
+    os << "\t\tFwd: " << record.fwd << "\n";
+    os << "\t\tData: \"Payload (size=" << record.size << ")\"" << "\n\n";
+    
+    return;
+}
+
+void
+AsyncTraceWriter::WriteCsvHeader(std::ostream &os)
+{
+    os << "time_ns,event,node,uid,src,dest,fwd,type,size,x,y,z,rx_power_dBm\n";
+    return;
+}
+
+void
+AsyncTraceWriter::WriteCsv(std::ostream &os, const LoRaTraceRecord &record)
+{
+    static const char *types[] = {"ROUTING_UPDATE", "DIRECTED", "FEEDBACK", "ROUTING_UPDATES", "FEEDBACKS"};
+    
+    os << record.time_ns << "," << ((record.event == LORA_TRACE_RX) ? "rx" : "tx") << "," << record.node << "," << record.uid << ",";
+    os << record.src << "," << record.dest << "," << record.fwd << "," << ((record.type < sizeof(types) / sizeof(types[0])) ? types[record.type] : "UNKNOWN") << "," << record.size << ",";
+    os << record.x << "," << record.y << "," << record.z << ",";
+    
+    if (!std::isnan(record.rx_power_dBm))
+    {
+        os << record.rx_power_dBm;
+    }
+    
+    os << "\n";
+    
+    return;
+}
+
+}
+}
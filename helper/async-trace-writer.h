@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 Sanjay Charran
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sanjay Charran <sanjaycharran@gmail.com>
+ */
+
+#ifndef __ASYNC_TRACE_WRITER_H__
+#define __ASYNC_TRACE_WRITER_H__
+
+#include "ns3/simple-ref-count.h"
+
+#include "ns3/lora-trace-record.h"
+
+#include <atomic>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ns3 {
+namespace lora_mesh {
+
+/**
+ *  \brief  Writes trace records to a file from a background thread
+ * 
+ *  The simulator thread pushes raw LoRaTraceRecords into a lock-free single producer, single
+ *  consumer ring buffer, and a background thread formats and writes them out, so that event
+ *  processing does not wait on formatting or on the file system. The ring buffer has a fixed
+ *  capacity: when the writer falls that far behind the simulator thread waits for room rather
+ *  than growing the buffer.
+ */
+class AsyncTraceWriter : public SimpleRefCount<AsyncTraceWriter>
+{
+public:
+    /**
+     *  Formats the records can be written in
+     */
+    enum Format
+    {
+        BINARY,     /*  LoRaTraceFileHeader followed by the raw records, as BinaryTraceHelperForLoRa    */
+        TEXT,       /*  the per packet blocks written by AsciiHelperForLoRa */
+        CSV         /*  one row per record  */
+    };
+    
+    /**
+     *  Opens the trace file and starts the writer thread
+     * 
+     *  \param  filename    name of the trace file to be written
+     *  \param  format      format the records are written in
+     *  \param  capacity    number of records the ring buffer holds, rounded up to a power of two
+     */
+    AsyncTraceWriter(std::string filename, Format format, uint32_t capacity);
+    ~AsyncTraceWriter();
+    
+    /**
+     *  Queues a record to be written, waiting for room if the ring buffer is full. Must only be
+     *  called from one thread, and not after Close.
+     * 
+     *  \param  record  the record to be written
+     */
+    void Push(const LoRaTraceRecord &record);
+    
+    /**
+     *  Waits until every record pushed so far is written and flushed to the file
+     */
+    void Flush(void);
+    
+    /**
+     *  Writes the remaining records, stops the writer thread and closes the file
+     */
+    void Close(void);
+    
+    /**
+     *  Gets the number of times Push had to wait for the writer thread
+     * 
+     *  \return the number of pushes which found the ring buffer full
+     */
+    uint64_t GetNStalls(void) const;
+    
+    /**
+     *  Writes the header of a binary trace file
+     */
+    static void WriteFileHeader(std::ostream &os);
+    
+    /**
+     *  Writes a record in the text format of AsciiHelperForLoRa. The packet contents are not
+     *  part of a record, so only the payload size is written as data.
+     */
+    static void WriteText(std::ostream &os, const LoRaTraceRecord &record);
+    
+    /**
+     *  Writes the column names of the CSV format
+     */
+    static void WriteCsvHeader(std::ostream &os);
+    
+    /**
+     *  Writes a record as a CSV row
+     */
+    static void WriteCsv(std::ostream &os, const LoRaTraceRecord &record);
+    
+private:
+    /*  how long (us) the writer thread sleeps when there is nothing to write   */
+    static const uint32_t IDLE_US = 200;
+    
+    /**
+     *  Main loop of the writer thread
+     */
+    void Run(void);
+    
+    /**
+     *  Writes a record to the file in the configured format
+     */
+    void Write(const LoRaTraceRecord &record);
+    
+    std::ofstream                   m_file;
+    Format                          m_format;
+    
+    std::vector<LoRaTraceRecord>    m_ring;
+    uint64_t                        m_mask;
+    
+    /*  the consumer only writes m_head and the producer only writes m_tail, padded apart so
+        they do not share a cache line  */
+    std::atomic<uint64_t>   m_head;
+    char                    m_padding[64];
+    std::atomic<uint64_t>   m_tail;
+    
+    std::atomic<uint64_t>   m_flushRequests;
+    std::atomic<uint64_t>   m_flushesDone;
+    std::atomic<bool>       m_running;
+    uint64_t                m_stalls;
+    
+    std::thread m_thread;
+};
+
+}
+}
+
+#endif  /*  __ASYNC_TRACE_WRITER_H__    */
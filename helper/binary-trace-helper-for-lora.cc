@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 Sanjay Charran
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sanjay Charran <sanjaycharran@gmail.com>
+ */
+
+#include "ns3/binary-trace-helper-for-lora.h"
+
+#include <cstring>
+#include <limits>
+
+namespace ns3 {
+namespace lora_mesh {
+
+BinaryTraceHelperForLoRa::BinaryTraceHelperForLoRa(std::string filename, uint32_t buffer_records)
+{
+    m_bufferRecords = (buffer_records == 0) ? 1 : buffer_records;
+    m_nRecords = 0;
+    m_buffer.reserve(m_bufferRecords);
+    
+    m_file.open(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    NS_ABORT_MSG_UNLESS(m_file.is_open(), "Unable to open binary trace file " << filename);
+    
+    AsyncTraceWriter::WriteFileHeader(m_file);
+    
+    Simulator::ScheduleDestroy(&BinaryTraceHelperForLoRa::Close, this);
+}
+
+BinaryTraceHelperForLoRa::BinaryTraceHelperForLoRa(std::string filename, AsyncTraceWriter::Format format, uint32_t ring_records)
+{
+    m_bufferRecords = 0;
+    m_nRecords = 0;
+    m_writer = Create<AsyncTraceWriter>(filename, format, (ring_records == 0) ? 1 : ring_records);
+    
+    /*  drain the background thread before the simulator goes away   */
+    Simulator::ScheduleDestroy(&BinaryTraceHelperForLoRa::Close, this);
+}
+
+BinaryTraceHelperForLoRa::~BinaryTraceHelperForLoRa()
+{
+    Close();
+}
+
+void
+BinaryTraceHelperForLoRa::EnableBinary(Ptr<NetDevice> nd)
+{
+    Ptr<LoRaNetDevice> device = nd->GetObject<LoRaNetDevice>();
+    
+    if (device == 0 || device->GetMAC() == 0)
+    {
+        return;
+    }
+    
+    device->GetMAC()->TraceConnectWithoutContext("RxPacketSniffer", MakeBoundCallback(&BinaryTraceHelperForLoRa::RxSniffer, this, device));
+    device->GetMAC()->TraceConnectWithoutContext("TxPacketSniffer", MakeBoundCallback(&BinaryTraceHelperForLoRa::TxSniffer, this, device));
+    
+    return;
+}
+
+void
+BinaryTraceHelperForLoRa::EnableBinary(NetDeviceContainer devices)
+{
+    for (NetDeviceContainer::Iterator i = devices.Begin();i != devices.End();++i)
+    {
+        EnableBinary(*i);
+    }
+    
+    return;
+}
+
+void
+BinaryTraceHelperForLoRa::Flush(void)
+{
+    if (m_writer)
+    {
+        m_writer->Flush();
+        return;
+    }
+    
+    if (!m_buffer.empty() && m_file.is_open())
+    {
+        m_file.write(reinterpret_cast<const char *>(m_buffer.data()), m_buffer.size() * sizeof(LoRaTraceRecord));
+        m_file.flush();
+    }
+    
+    m_buffer.clear();
+    return;
+}
+
+void
+BinaryTraceHelperForLoRa::Close(void)
+{
+    if (m_writer)
+    {
+        m_writer->Close();
+        return;
+    }
+    
+    Flush();
+    m_file.close();
+    
+    return;
+}
+
+uint64_t
+BinaryTraceHelperForLoRa::GetNRecords(void) const
+{
+    return m_nRecords;
+}
+
+void
+BinaryTraceHelperForLoRa::RxSniffer(BinaryTraceHelperForLoRa *helper, Ptr<LoRaNetDevice> device, Ptr<Packet> packet)
+{
+    /*  the MAC sniffer fires while the PHY is passing the packet up   */
+    helper->Record(device, packet, LORA_TRACE_RX, device->GetPHY()->GetLastRxPower());
+    return;
+}
+
+void
+BinaryTraceHelperForLoRa::TxSniffer(BinaryTraceHelperForLoRa *helper, Ptr<LoRaNetDevice> device, Ptr<Packet> packet)
+{
+    helper->Record(device, packet, LORA_TRACE_TX, std::numeric_limits<double>::quiet_NaN());
+    return;
+}
+
+void
+BinaryTraceHelperForLoRa::Record(Ptr<LoRaNetDevice> device, Ptr<Packet> packet, uint8_t event, double rx_power_dBm)
+{
+    LoRaMeshHeader header;
+    LoRaTraceRecord record;
+    Ptr<MobilityModel> mobility = device->GetNode()->GetObject<MobilityModel>();
+    Vector3D pos;
+    
+    packet->PeekHeader(header);
+    
+    if (mobility)
+    {
+        pos = mobility->GetPosition();
+    }
+    
+    std::memset(&record, 0, sizeof(record));
+    record.time_ns = Simulator::Now().GetNanoSeconds();
+    record.uid = packet->GetUid();
+    record.x = pos.x;
+    record.y = pos.y;
+    record.z = pos.z;
+    record.rx_power_dBm = rx_power_dBm;
+    record.node = device->GetNode()->GetId();
+    record.src = header.GetSrc();
+    record.dest = header.GetDest();
+    record.fwd = header.GetFwd();
+    record.size = packet->GetSize();
+    record.type = header.GetType();
+    record.event = event;
+    
+    m_nRecords++;
+    
+    if (m_writer)
+    {
+        m_writer->Push(record);
+        return;
+    }
+    
+    m_buffer.push_back(record);
+    
+    if (m_buffer.size() >= m_bufferRecords)
+    {
+        Flush();
+    }
+    
+    return;
+}
+
+}
+}
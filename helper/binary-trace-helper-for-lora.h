@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 Sanjay Charran
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sanjay Charran <sanjaycharran@gmail.com>
+ */
+
+#ifndef __BINARY_TRACE_HELPER_FOR_LORA_H__
+#define __BINARY_TRACE_HELPER_FOR_LORA_H__
+
+#include "ns3/ptr.h"
+#include "ns3/net-device.h"
+#include "ns3/net-device-container.h"
+#include "ns3/simulator.h"
+#include "ns3/mobility-model.h"
+#include "ns3/vector.h"
+
+#include "ns3/lora-net-device.h"
+#include "ns3/lora-mac.h"
+#include "ns3/lora-trace-record.h"
+#include "ns3/async-trace-writer.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+namespace lora_mesh {
+
+/**
+ *  \brief  Writes the packets sniffed by LoRaMACs to a compact binary trace
+ * 
+ *  An alternative to AsciiHelperForLoRa for long runs: every sniffed packet becomes a fixed-size
+ *  LoRaTraceRecord which is collected in a large in-memory buffer and written out in bulk. The
+ *  lora-trace-converter example turns a binary trace into the text format of AsciiHelperForLoRa
+ *  or into CSV. Alternatively the records can be handed to an AsyncTraceWriter, which formats
+ *  and writes them from a background thread.
+ */
+class BinaryTraceHelperForLoRa
+{
+public:
+    /**
+     *  \param  filename        name of the binary trace file to be written
+     *  \param  buffer_records  number of records buffered in memory between writes
+     */
+    BinaryTraceHelperForLoRa(std::string filename, uint32_t buffer_records = 65536);
+    
+    /**
+     *  Hands the records to a background thread which formats and writes them, instead of
+     *  writing from the simulator thread
+     * 
+     *  \param  filename        name of the trace file to be written
+     *  \param  format          format the background thread writes the records in
+     *  \param  ring_records    number of records in flight between the simulator and the
+     *                          background thread
+     */
+    BinaryTraceHelperForLoRa(std::string filename, AsyncTraceWriter::Format format, uint32_t ring_records = 65536);
+    ~BinaryTraceHelperForLoRa();
+    
+    /**
+     *  Enables binary tracing of the packets sent and received by the LoRaMAC of a device
+     * 
+     *  \param  nd  the LoRaNetDevice to be traced
+     */
+    void EnableBinary(Ptr<NetDevice> nd);
+    
+    /**
+     *  Enables binary tracing of the packets sent and received by the LoRaMACs of devices
+     * 
+     *  \param  devices the LoRaNetDevices to be traced
+     */
+    void EnableBinary(NetDeviceContainer devices);
+    
+    /**
+     *  Writes the buffered records to the trace file
+     */
+    void Flush(void);
+    
+    /**
+     *  Writes the remaining records and closes the trace file, stopping the background thread
+     *  if there is one
+     */
+    void Close(void);
+    
+    /**
+     *  Gets the number of records traced so far
+     * 
+     *  \return the number of records traced
+     */
+    uint64_t GetNRecords(void) const;
+    
+private:
+    static void RxSniffer(BinaryTraceHelperForLoRa *helper, Ptr<LoRaNetDevice> device, Ptr<Packet> packet);
+    static void TxSniffer(BinaryTraceHelperForLoRa *helper, Ptr<LoRaNetDevice> device, Ptr<Packet> packet);
+    
+    /**
+     *  Fills in and buffers a record for a sniffed packet
+     */
+    void Record(Ptr<LoRaNetDevice> device, Ptr<Packet> packet, uint8_t event, double rx_power_dBm);
+    
+    std::ofstream                   m_file;
+    Ptr<AsyncTraceWriter>           m_writer;
+    std::vector<LoRaTraceRecord>    m_buffer;
+    uint32_t                        m_bufferRecords;
+    uint64_t                        m_nRecords;
+};
+
+}
+}
+
+#endif  /*  __BINARY_TRACE_HELPER_FOR_LORA_H__  */
@@ -0,0 +1,67 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 Sanjay Charran
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sanjay Charran <sanjaycharran@gmail.com>
+ */
+
+#include "ns3/lora-mac-helper.h"
+
+namespace ns3 {
+namespace lora_mesh {
+
+LoRaMacHelper::LoRaMacHelper()
+{
+    m_mac.SetTypeId("ns3::LoRaMAC");
+}
+
+LoRaMacHelper::~LoRaMacHelper()
+{
+}
+
+void
+LoRaMacHelper::Set(std::string name, const AttributeValue &value)
+{
+    m_mac.Set(name, value);
+    return;
+}
+
+Ptr<LoRaMAC>
+LoRaMacHelper::Create(void) const
+{
+    return m_mac.Create<LoRaMAC>();
+}
+
+int64_t
+LoRaMacHelper::AssignStreams(NetDeviceContainer devices, int64_t stream)
+{
+    int64_t current = stream;
+    
+    for (NetDeviceContainer::Iterator i = devices.Begin();i != devices.End();++i)
+    {
+        Ptr<LoRaNetDevice> device = DynamicCast<LoRaNetDevice>(*i);
+        
+        if (device && device->GetMAC())
+        {
+            current += device->GetMAC()->AssignStreams(current);
+        }
+    }
+    
+    return (current - stream);
+}
+
+}
+}
@@ -0,0 +1,77 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 Sanjay Charran
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sanjay Charran <sanjaycharran@gmail.com>
+ */
+
+#ifndef __LORA_MAC_HELPER_H__
+#define __LORA_MAC_HELPER_H__
+
+#include "ns3/ptr.h"
+#include "ns3/net-device-container.h"
+#include "ns3/object-factory.h"
+#include "ns3/attribute.h"
+
+#include "ns3/lora-net-device.h"
+#include "ns3/lora-mac.h"
+
+#include <string>
+
+namespace ns3 {
+namespace lora_mesh {
+
+/**
+ *  \brief  Helper for creating and configuring the LoRaMACs of a set of LoRaNetDevices
+ */
+class LoRaMacHelper
+{
+public:
+    LoRaMacHelper();
+    ~LoRaMacHelper();
+    
+    /**
+     *  Sets an attribute of the LoRaMACs to be created
+     * 
+     *  \param  name    name of the LoRaMAC attribute
+     *  \param  value   value of the attribute
+     */
+    void Set(std::string name, const AttributeValue &value);
+    
+    /**
+     *  \return a new LoRaMAC with the attributes set on the helper
+     */
+    Ptr<LoRaMAC> Create(void) const;
+    
+    /**
+     *  Assigns fixed random variable stream numbers to the LoRaMACs of the given devices, so that
+     *  runs can be reproduced across replications
+     * 
+     *  \param  devices the LoRaNetDevices whose LoRaMACs are to be assigned streams
+     *  \param  stream  first stream index to use
+     * 
+     *  \return the number of stream indices assigned
+     */
+    int64_t AssignStreams(NetDeviceContainer devices, int64_t stream);
+    
+private:
+    ObjectFactory m_mac;
+};
+
+}
+}
+
+#endif  /*  __LORA_MAC_HELPER_H__   */
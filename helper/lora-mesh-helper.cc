@@ -0,0 +1,92 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 Sanjay Charran
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sanjay Charran <sanjaycharran@gmail.com>
+ */
+
+#include "ns3/lora-mesh-helper.h"
+#include "ns3/log.h"
+
+#include <vector>
+
+namespace ns3 {
+namespace lora_mesh {
+
+NS_LOG_COMPONENT_DEFINE("LoRaMeshHelper");
+
+LoRaMeshHelper::LoRaMeshHelper()
+{
+}
+
+LoRaMeshHelper::~LoRaMeshHelper()
+{
+}
+
+NetDeviceContainer
+LoRaMeshHelper::Install(const LoRaPhyHelper &phy, const LoRaMacHelper &mac, NodeContainer c) const
+{
+    NS_LOG_FUNCTION(this << c.GetN());
+    
+    NetDeviceContainer devices;
+    std::vector<Ptr<LoRaPHY>> phys;
+    
+    phys.reserve(c.GetN());
+    
+    for (NodeContainer::Iterator i = c.Begin();i != c.End();++i)
+    {
+        Ptr<Node> node = *i;
+        Ptr<LoRaNetDevice> device = CreateObject<LoRaNetDevice>();
+        Ptr<LoRaPHY> lora_phy = phy.Create(device);
+        Ptr<LoRaMAC> lora_mac = mac.Create();
+        
+        lora_phy->SetMAC(lora_mac);
+        device->SetMAC(lora_mac);
+        device->SetPHY(lora_phy);
+        device->SetNode(node);
+        node->AddDevice(device);
+        lora_mac->SetPHY(lora_phy);
+        lora_mac->SetDevice(device);
+        
+        phys.push_back(lora_phy);
+        devices.Add(device);
+    }
+    
+    /*  one sorted merge instead of a sorted insert per LoRaPHY */
+    if (phy.GetChannel())
+    {
+        phy.GetChannel()->AddPHYs(phys);
+    }
+    
+    return devices;
+}
+
+NetDeviceContainer
+LoRaMeshHelper::Install(const LoRaPhyHelper &phy, const LoRaMacHelper &mac, Ptr<Node> node) const
+{
+    return Install(phy, mac, NodeContainer(node));
+}
+
+int64_t
+LoRaMeshHelper::AssignStreams(NetDeviceContainer devices, int64_t stream)
+{
+    LoRaMacHelper mac;
+    
+    return mac.AssignStreams(devices, stream);
+}
+
+}
+}
@@ -0,0 +1,81 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 Sanjay Charran
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sanjay Charran <sanjaycharran@gmail.com>
+ */
+
+#ifndef __LORA_MESH_HELPER_H__
+#define __LORA_MESH_HELPER_H__
+
+#include "ns3/ptr.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+
+#include "ns3/lora-phy-helper.h"
+#include "ns3/lora-mac-helper.h"
+
+namespace ns3 {
+namespace lora_mesh {
+
+/**
+ *  \brief  Helper for installing LoRaNetDevices (with their LoRaPHY and LoRaMAC) on nodes
+ */
+class LoRaMeshHelper
+{
+public:
+    LoRaMeshHelper();
+    ~LoRaMeshHelper();
+    
+    /**
+     *  Creates a LoRaNetDevice with a LoRaPHY and LoRaMAC for each of the nodes and attaches all
+     *  of the LoRaPHYs to the LoRaPHY helper's channel at once
+     * 
+     *  \param  phy     helper used to create the LoRaPHYs
+     *  \param  mac     helper used to create the LoRaMACs
+     *  \param  c       the nodes to install the LoRaNetDevices on
+     * 
+     *  \return the installed LoRaNetDevices, in the order of the nodes
+     */
+    NetDeviceContainer Install(const LoRaPhyHelper &phy, const LoRaMacHelper &mac, NodeContainer c) const;
+    
+    /**
+     *  Creates a LoRaNetDevice with a LoRaPHY and LoRaMAC for a single node
+     * 
+     *  \param  phy     helper used to create the LoRaPHY
+     *  \param  mac     helper used to create the LoRaMAC
+     *  \param  node    the node to install the LoRaNetDevice on
+     * 
+     *  \return the installed LoRaNetDevice
+     */
+    NetDeviceContainer Install(const LoRaPhyHelper &phy, const LoRaMacHelper &mac, Ptr<Node> node) const;
+    
+    /**
+     *  Assigns fixed random variable stream numbers to the LoRaMACs of the given devices
+     * 
+     *  \param  devices the LoRaNetDevices whose LoRaMACs are to be assigned streams
+     *  \param  stream  first stream index to use
+     * 
+     *  \return the number of stream indices assigned
+     */
+    int64_t AssignStreams(NetDeviceContainer devices, int64_t stream);
+};
+
+}
+}
+
+#endif  /*  __LORA_MESH_HELPER_H__  */
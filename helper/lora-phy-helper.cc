@@ -0,0 +1,71 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 Sanjay Charran
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sanjay Charran <sanjaycharran@gmail.com>
+ */
+
+#include "ns3/lora-phy-helper.h"
+
+namespace ns3 {
+namespace lora_mesh {
+
+LoRaPhyHelper::LoRaPhyHelper()
+{
+    m_phy.SetTypeId("ns3::LoRaPHY");
+}
+
+LoRaPhyHelper::~LoRaPhyHelper()
+{
+}
+
+void
+LoRaPhyHelper::SetChannel(Ptr<LoRaChannel> channel)
+{
+    m_channel = channel;
+    return;
+}
+
+Ptr<LoRaChannel>
+LoRaPhyHelper::GetChannel(void) const
+{
+    return m_channel;
+}
+
+void
+LoRaPhyHelper::Set(std::string name, const AttributeValue &value)
+{
+    m_phy.Set(name, value);
+    return;
+}
+
+Ptr<LoRaPHY>
+LoRaPhyHelper::Create(Ptr<LoRaNetDevice> device) const
+{
+    Ptr<LoRaPHY> phy = m_phy.Create<LoRaPHY>();
+    
+    phy->SetNetDevice(device);
+    
+    if (m_channel)
+    {
+        phy->SetChannel(m_channel);
+    }
+    
+    return phy;
+}
+
+}
+}
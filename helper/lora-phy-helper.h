@@ -0,0 +1,85 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 Sanjay Charran
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sanjay Charran <sanjaycharran@gmail.com>
+ */
+
+#ifndef __LORA_PHY_HELPER_H__
+#define __LORA_PHY_HELPER_H__
+
+#include "ns3/ptr.h"
+#include "ns3/object-factory.h"
+#include "ns3/attribute.h"
+
+#include "ns3/lora-net-device.h"
+#include "ns3/lora-phy.h"
+#include "ns3/lora-channel.h"
+
+#include <string>
+
+namespace ns3 {
+namespace lora_mesh {
+
+/**
+ *  \brief  Helper for creating LoRaPHYs with a common configuration
+ */
+class LoRaPhyHelper
+{
+public:
+    LoRaPhyHelper();
+    ~LoRaPhyHelper();
+    
+    /**
+     *  Sets the LoRaChannel the created LoRaPHYs will use
+     * 
+     *  \param  channel the LoRaChannel for the LoRaPHYs
+     */
+    void SetChannel(Ptr<LoRaChannel> channel);
+    
+    /**
+     *  \return the LoRaChannel the created LoRaPHYs will use
+     */
+    Ptr<LoRaChannel> GetChannel(void) const;
+    
+    /**
+     *  Sets an attribute of the LoRaPHYs to be created
+     * 
+     *  \param  name    name of the LoRaPHY attribute
+     *  \param  value   value of the attribute
+     */
+    void Set(std::string name, const AttributeValue &value);
+    
+    /**
+     *  Creates a LoRaPHY for a LoRaNetDevice. The LoRaPHY uses the helper's LoRaChannel but is 
+     *  not attached to it, so that a whole set of LoRaPHYs can be attached with 
+     *  LoRaChannel::AddPHYs.
+     * 
+     *  \param  device  the LoRaNetDevice the LoRaPHY belongs to
+     * 
+     *  \return the new LoRaPHY
+     */
+    Ptr<LoRaPHY> Create(Ptr<LoRaNetDevice> device) const;
+    
+private:
+    ObjectFactory m_phy;
+    Ptr<LoRaChannel> m_channel;
+};
+
+}
+}
+
+#endif  /*  __LORA_PHY_HELPER_H__   */
@@ -0,0 +1,80 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 Sanjay Charran
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sanjay Charran <sanjaycharran@gmail.com>
+ */
+
+#ifndef __LORA_TRACE_RECORD_H__
+#define __LORA_TRACE_RECORD_H__
+
+#include <stdint.h>
+
+/*  binary trace file layout: a LoRaTraceFileHeader followed by fixed-size LoRaTraceRecords,
+    all in host byte order    */
+#define LORA_TRACE_MAGIC    0x52544d4c  /*  "LMTR" on little-endian hosts  */
+#define LORA_TRACE_VERSION  1
+
+namespace ns3 {
+namespace lora_mesh {
+
+/**
+ *  Enumerated type for the events recorded in a binary trace
+ */
+enum LoRaTraceEvent
+{
+    LORA_TRACE_RX = 0,      /*  data packet received by the LoRaMAC */
+    LORA_TRACE_TX = 1       /*  data packet transmitted by the LoRaMAC  */
+};
+
+/*
+ *  Header at the start of a binary trace file
+ */
+struct LoRaTraceFileHeader
+{
+    uint32_t    magic;
+    uint32_t    version;
+    uint32_t    record_size;
+    uint32_t    reserved;
+};
+
+/*
+ *  A single event in a binary trace file
+ */
+struct LoRaTraceRecord
+{
+    int64_t     time_ns;        /*  simulation time of the event (ns)   */
+    uint64_t    uid;            /*  packet ID   */
+    double      x;              /*  position of the node    */
+    double      y;
+    double      z;
+    double      rx_power_dBm;   /*  power of the received signal, NaN for transmissions */
+    uint32_t    node;           /*  Node ID of the node the event occurred at   */
+    uint32_t    src;            /*  mesh header fields  */
+    uint32_t    dest;
+    uint32_t    fwd;
+    uint32_t    size;           /*  packet size (bytes) */
+    uint8_t     type;           /*  MsgType of the packet   */
+    uint8_t     event;          /*  LoRaTraceEvent  */
+    uint8_t     reserved[2];
+};
+
+static_assert (sizeof (LoRaTraceRecord) == 72, "LoRaTraceRecord must stay 72 bytes");
+
+}
+}
+
+#endif  /*  __LORA_TRACE_RECORD_H__ */
@@ -20,9 +20,19 @@
 
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/pointer.h"
+#include "ns3/abort.h"
 
 #include "ns3/lora-channel.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
 namespace ns3 {
 namespace lora_mesh {
 
@@ -34,6 +44,58 @@ LoRaChannel::GetTypeId (void)
     static TypeId tid = TypeId ("ns3::LoRaChannel")
         .SetParent<Channel> ()
         .SetGroupName ("lora_mesh")
+        .AddAttribute ("SpatialIndex",
+                       "Whether a uniform grid is used to only visit LoRaPHYs within range of the sender",
+                       BooleanValue (false),
+                       MakeBooleanAccessor (&LoRaChannel::m_spatialIndex),
+                       MakeBooleanChecker ())
+        .AddAttribute ("MaxRange",
+                       "Upper bound (in m) on the range of any transmission, 0 to derive it from the loss model",
+                       DoubleValue (0),
+                       MakeDoubleAccessor (&LoRaChannel::m_maxRange),
+                       MakeDoubleChecker<double> (0))
+        .AddAttribute ("RangeMargin",
+                       "Margin (in dB) below the lowest sensitivity still delivered so that weak signals are kept as interferers",
+                       DoubleValue (6),
+                       MakeDoubleAccessor (&LoRaChannel::m_rangeMargin),
+                       MakeDoubleChecker<double> (0))
+        .AddAttribute ("GridCellSize",
+                       "Size (in m) of the spatial grid cells, 0 to use the range of the first transmission",
+                       DoubleValue (0),
+                       MakeDoubleAccessor (&LoRaChannel::m_cellSize),
+                       MakeDoubleChecker<double> (0))
+        .AddAttribute ("FrequencyBuckets",
+                       "Whether signals are only delivered to the LoRaPHYs listening on their frequency",
+                       BooleanValue (false),
+                       MakeBooleanAccessor (&LoRaChannel::m_frequencyBuckets),
+                       MakeBooleanChecker ())
+        .AddAttribute ("StaticTopology",
+                       "Whether the loss and delay of each link are cached until either end changes position",
+                       BooleanValue (false),
+                       MakeBooleanAccessor (&LoRaChannel::m_staticTopology),
+                       MakeBooleanChecker ())
+        .AddAttribute ("StochasticLossModel",
+                       "Loss model applied after the loss model of the channel, which is then treated "
+                       "as deterministic, e.g. to add fading or shadowing",
+                       PointerValue (),
+                       MakePointerAccessor (&LoRaChannel::SetStochasticLossModel,
+                                            &LoRaChannel::GetStochasticLossModel),
+                       MakePointerChecker<PropagationLossModel> ())
+        .AddAttribute ("FreezeStochasticLoss",
+                       "With a static topology, cache the loss of the StochasticLossModel along with the "
+                       "rest of the link (true) or re-sample it for every packet (false)",
+                       BooleanValue (true),
+                       MakeBooleanAccessor (&LoRaChannel::m_freezeStochasticLoss),
+                       MakeBooleanChecker ())
+        .AddAttribute ("CollisionMatrix",
+                       "Collision matrix used by the LoRaPHYs on the channel to decide whether "
+                       "interference destroys a packet",
+                       EnumValue (LoraInterferenceHelper::GOURSAUD),
+                       MakeEnumAccessor (&LoRaChannel::SetCollisionMatrix,
+                                         &LoRaChannel::GetCollisionMatrix),
+                       MakeEnumChecker (LoraInterferenceHelper::GOURSAUD, "Goursaud",
+                                        LoraInterferenceHelper::ALOHA, "Aloha",
+                                        LoraInterferenceHelper::CUSTOM, "Custom"))
         .AddTraceSource("PacketSent",
                         "Trace source fired whenever a packet goes out on the channel",
                         MakeTraceSourceAccessor (&LoRaChannel::m_packetSent),
@@ -44,6 +106,24 @@ LoRaChannel::GetTypeId (void)
 
 LoRaChannel::LoRaChannel ()
 {
+    m_spatialIndex = false;
+    m_maxRange = 0;
+    m_rangeMargin = 6;
+    m_cellSize = 0;
+    m_minRxSens = std::numeric_limits<double>::max();
+    m_rangeDerived = false;
+    m_rangeExponent = 0;
+    m_rangeRefDistance = 0;
+    m_rangeRefLoss = 0;
+    m_gridBuilt = false;
+    m_maxSpeed = 0;
+    m_staticTopology = false;
+    m_freezeStochasticLoss = true;
+    m_frequencyBuckets = false;
+    m_recordOnAir = false;
+    m_bucketsDirty = true;
+    m_collisionMatrix = LoraInterferenceHelper::GOURSAUD;
+    m_collisionSnir = LoraInterferenceHelper::collisionSnirGoursaud;
 }
 
 LoRaChannel::~LoRaChannel ()
@@ -89,6 +169,19 @@ LoRaChannel::AddPHY (Ptr<LoRaPHY> phy)
     
     uint32_t id;
     
+    NotifyRxSensChanged (phy->GetRxSens());
+    m_bucketsDirty = true;
+    
+    if (phy->IsLazyInterferenceEnabled())
+    {
+        NotifyLazyInterference ();
+    }
+    
+    if (m_gridBuilt)
+    {
+        IndexPHY (phy);
+    }
+    
     if (phy->GetNetDevice() && phy->GetNetDevice()->GetNode())
     {
         id = phy->GetNetDevice()->GetNode()->GetId();
@@ -120,6 +213,80 @@ LoRaChannel::AddPHY (Ptr<LoRaPHY> phy)
     return;
 }
 
+void
+LoRaChannel::AddPHYs (const std::vector<Ptr<LoRaPHY>> &phys)
+{
+    NS_LOG_FUNCTION (this << phys.size ());
+    
+    std::vector<std::pair<uint32_t, Ptr<LoRaPHY>>> sorted;
+    std::vector<Ptr<LoRaPHY>> unsorted;
+    std::deque<Ptr<LoRaPHY>> merged;
+    
+    sorted.reserve (phys.size ());
+    
+    std::vector<Ptr<LoRaPHY>>::const_iterator it = phys.begin();
+    
+    for (;it != phys.end();++it)
+    {
+        NotifyRxSensChanged ((*it)->GetRxSens());
+        
+        if ((*it)->IsLazyInterferenceEnabled())
+        {
+            NotifyLazyInterference ();
+        }
+        
+        if (m_gridBuilt)
+        {
+            IndexPHY (*it);
+        }
+        
+        if ((*it)->GetNetDevice() && (*it)->GetNetDevice()->GetNode())
+        {
+            sorted.push_back (std::make_pair ((*it)->GetNetDevice()->GetNode()->GetId(), *it));
+        }
+        else
+        {
+            unsorted.push_back (*it);
+        }
+    }
+    
+    m_bucketsDirty = true;
+    
+    /*  stable so LoRaPHYs of the same node keep the order they were given in   */
+    std::stable_sort (sorted.begin(), sorted.end(),
+                      [] (const std::pair<uint32_t, Ptr<LoRaPHY>> &a, const std::pair<uint32_t, Ptr<LoRaPHY>> &b)
+                      { return a.first < b.first; });
+    
+    std::vector<std::pair<uint32_t, Ptr<LoRaPHY>>>::iterator next = sorted.begin();
+    std::deque<Ptr<LoRaPHY>>::iterator iter = m_phyList.begin();
+    
+    /*  insert each new LoRaPHY before the first attached one with a higher node id, as AddPHY does */
+    for (;iter != m_phyList.end();++iter)
+    {
+        if ((*iter)->GetNetDevice() && (*iter)->GetNetDevice()->GetNode())
+        {
+            uint32_t id = (*iter)->GetNetDevice()->GetNode()->GetId();
+            
+            for (;next != sorted.end() && next->first < id;++next)
+            {
+                merged.push_back (next->second);
+            }
+        }
+        
+        merged.push_back (*iter);
+    }
+    
+    for (;next != sorted.end();++next)
+    {
+        merged.push_back (next->second);
+    }
+    
+    merged.insert (merged.end(), unsorted.begin(), unsorted.end());
+    m_phyList.swap (merged);
+    
+    return;
+}
+
 void
 LoRaChannel::RemovePHY (Ptr<LoRaPHY> phy)
 {
@@ -133,6 +300,15 @@ LoRaChannel::RemovePHY (Ptr<LoRaPHY> phy)
         {
             /*  if LoRaPHY is found remove it   */
             m_phyList.erase(iter);
+            
+            if (m_gridBuilt)
+            {
+                UnindexPHY (phy);
+            }
+            
+            UntrackPHY (phy);
+            m_bucketsDirty = true;
+            
             return;
         }
     }
@@ -145,6 +321,8 @@ void
 LoRaChannel::SetLossModel (Ptr<PropagationLossModel> loss)
 {
     m_lossModel = loss;
+    UpdateRangeBound ();
+    
     return;
 }
 
@@ -154,6 +332,24 @@ LoRaChannel::GetLossModel (void) const
     return m_lossModel;
 }
 
+void
+LoRaChannel::SetStochasticLossModel (Ptr<PropagationLossModel> loss)
+{
+    m_stochasticLossModel = loss;
+    UpdateRangeBound ();
+    
+    /*  cached links may hold samples of the previous model */
+    m_links.clear();
+    
+    return;
+}
+
+Ptr<PropagationLossModel> 
+LoRaChannel::GetStochasticLossModel (void) const
+{
+    return m_stochasticLossModel;
+}
+
 void
 LoRaChannel::SetDelayModel (Ptr<PropagationDelayModel> delay)
 {
@@ -172,43 +368,281 @@ LoRaChannel::Send (Ptr<LoRaPHY> sender, Ptr<Packet> packet, double tx_power_dBm,
 {
     NS_LOG_FUNCTION(this << packet << sender);
     
-    Ptr<MobilityModel> sender_mobility = sender->GetMobility();
-    Ptr<MobilityModel> receiver_mobility;
-    Time delay;
-    double rx_power_dBm;
-    uint32_t dst_id;
+    double range = -1;
     
-    std::deque<Ptr<LoRaPHY>>::iterator i = m_phyList.begin();
+    if (m_spatialIndex && sender->GetMobility())
+    {
+        range = GetMaxRange (tx_power_dBm);
+    }
     
-    for (;i != m_phyList.end();++i)
+    if (m_frequencyBuckets || m_recordOnAir)
     {
-        if (sender != (*i))
+        AddOnAirSignal (sender, packet, tx_power_dBm, tx_freq_MHz, tx_sf, dur);
+    }
+    
+    if (range < 0 && m_frequencyBuckets)
+    {
+        /*  only the LoRaPHYs listening on the frequency can be affected by the signal  */
+        const std::vector<Ptr<LoRaPHY>> &bucket = GetFrequencyBucket (tx_freq_MHz);
+        
+        for (std::size_t j = 0;j < bucket.size();j++)
         {
-            receiver_mobility = (*i)->GetMobility();
-            
-            /*  get delay for packet to arrive at receiver  */
-            delay = m_delayModel->GetDelay(sender_mobility, receiver_mobility);
+            if (sender != bucket[j])
+            {
+                SendToPHY (sender, bucket[j], packet, tx_power_dBm, tx_freq_MHz, tx_sf, dur);
+            }
+        }
+        
+        return;
+    }
+    else if (range < 0)
+    {
+        /*  no spatial index, no usable range bound or no sender position -- visit every LoRaPHY   */
+        std::deque<Ptr<LoRaPHY>>::iterator i = m_phyList.begin();
+        
+        for (;i != m_phyList.end();++i)
+        {
+            if (sender != (*i))
+            {
+                SendToPHY (sender, (*i), packet, tx_power_dBm, tx_freq_MHz, tx_sf, dur);
+            }
+        }
+        
+        return;
+    }
+    
+    if (!m_gridBuilt)
+    {
+        BuildGrid (range);
+    }
+    
+    /*  bound how far moving LoRaPHYs may have drifted from their cells  */
+    double drift = m_maxSpeed * (Simulator::Now() - m_lastRebin).GetSeconds();
+    
+    if (drift > m_cellSize / 2)
+    {
+        RebinMobile ();
+        drift = 0;
+    }
+    
+    Vector3D pos = sender->GetMobility()->GetPosition();
+    double radius = range + drift;
+    int64_t reach = (int64_t)std::ceil(radius / m_cellSize);
+    int64_t cx = (int64_t)std::floor(pos.x / m_cellSize);
+    int64_t cy = (int64_t)std::floor(pos.y / m_cellSize);
+    
+    std::unordered_map<int64_t, std::vector<Ptr<LoRaPHY>>>::iterator cell;
+    std::vector<Ptr<LoRaPHY>>::iterator i;
+    
+    for (int64_t x = cx - reach;x <= cx + reach;x++)
+    {
+        for (int64_t y = cy - reach;y <= cy + reach;y++)
+        {
+            cell = m_grid.find(GetCellKey(x, y));
             
-            rx_power_dBm = GetRxPower (tx_power_dBm, sender_mobility, receiver_mobility);
+            if (cell == m_grid.end())
+            {
+                continue;
+            }
             
-            if ((*i)->GetNetDevice())
+            for (i = cell->second.begin();i != cell->second.end();++i)
             {
-                dst_id = (*i)->GetNetDevice()->GetNode()->GetId();
+                if (m_frequencyBuckets && (*i)->GetRxFreq() != tx_freq_MHz)
+                {
+                    continue;
+                }
+                
+                if (sender != (*i) && CalculateDistance(pos, (*i)->GetMobility()->GetPosition()) <= range)
+                {
+                    SendToPHY (sender, (*i), packet, tx_power_dBm, tx_freq_MHz, tx_sf, dur);
+                }
             }
-            else
+        }
+    }
+    
+    /*  LoRaPHYs without a MobilityModel are not in any cell, leave the range check to the models  */
+    for (i = m_unindexed.begin();i != m_unindexed.end();++i)
+    {
+        if (m_frequencyBuckets && (*i)->GetRxFreq() != tx_freq_MHz)
+        {
+            continue;
+        }
+        
+        if (sender != (*i))
+        {
+            SendToPHY (sender, (*i), packet, tx_power_dBm, tx_freq_MHz, tx_sf, dur);
+        }
+    }
+    
+    return;
+}
+
+void
+LoRaChannel::SendToPHY (Ptr<LoRaPHY> sender, Ptr<LoRaPHY> receiver, Ptr<Packet> packet, double tx_power_dBm, double tx_freq_MHz, uint8_t tx_sf, Time dur)
+{
+    Time delay;
+    double rx_power_dBm;
+    
+    GetLink (sender, receiver, tx_power_dBm, rx_power_dBm, delay);
+    
+    Simulator::ScheduleWithContext (GetContext(receiver), delay, &LoRaChannel::Receive, this, receiver, packet, rx_power_dBm, tx_freq_MHz, tx_sf, dur);
+    
+    m_packetSent(packet);
+    
+    return;
+}
+
+void
+LoRaChannel::GetLink (Ptr<LoRaPHY> sender, Ptr<LoRaPHY> receiver, double tx_power_dBm, double &rx_power_dBm, Time &delay)
+{
+    Ptr<MobilityModel> sender_mobility;
+    Ptr<MobilityModel> receiver_mobility;
+    
+    if (m_staticTopology && IsStationary(sender) && IsStationary(receiver))
+    {
+        GetCachedLink (sender, receiver, tx_power_dBm, rx_power_dBm, delay);
+    }
+    else
+    {
+        sender_mobility = sender->GetMobility();
+        receiver_mobility = receiver->GetMobility();
+        
+        /*  get delay for packet to arrive at receiver  */
+        delay = m_delayModel->GetDelay(sender_mobility, receiver_mobility);
+        
+        rx_power_dBm = GetRxPower (tx_power_dBm, sender_mobility, receiver_mobility);
+    }
+    
+    return;
+}
+
+uint32_t
+LoRaChannel::GetContext (Ptr<LoRaPHY> receiver) const
+{
+    if (receiver->GetNetDevice())
+    {
+        return receiver->GetNetDevice()->GetNode()->GetId();
+    }
+    
+    return 0;
+}
+
+const std::vector<Ptr<LoRaPHY>> &
+LoRaChannel::GetFrequencyBucket (double freq_MHz)
+{
+    if (m_bucketsDirty)
+    {
+        /*  rebuilt from the LoRaPHY list to keep the node id ordering   */
+        m_freqBuckets.clear();
+        
+        std::deque<Ptr<LoRaPHY>>::iterator it = m_phyList.begin();
+        
+        for (;it != m_phyList.end();++it)
+        {
+            m_freqBuckets[(*it)->GetRxFreq()].push_back(*it);
+        }
+        
+        m_bucketsDirty = false;
+    }
+    
+    return m_freqBuckets[freq_MHz];
+}
+
+void
+LoRaChannel::NotifyRxFreqChanged (Ptr<LoRaPHY> phy, double freq_MHz)
+{
+    NS_LOG_FUNCTION (this << phy << freq_MHz);
+    
+    if (!m_frequencyBuckets)
+    {
+        return;
+    }
+    
+    m_bucketsDirty = true;
+    
+    /*  the LoRaPHY missed the signals already on air on its new frequency  */
+    ReplayOnAirSignals (phy, freq_MHz, true);
+    
+    return;
+}
+
+void
+LoRaChannel::NotifyLazyInterference (void)
+{
+    m_recordOnAir = true;
+    return;
+}
+
+void
+LoRaChannel::ReplayOnAirSignals (Ptr<LoRaPHY> phy, double freq_MHz, bool propagating)
+{
+    NS_LOG_FUNCTION (this << phy << freq_MHz << propagating);
+    
+    if (!m_frequencyBuckets && !m_recordOnAir)
+    {
+        return;     /*  signals on air are not recorded */
+    }
+    
+    std::deque<OnAirSignal> &signals = m_onAir[freq_MHz];
+    std::deque<OnAirSignal>::iterator it = signals.begin();
+    Time now = Simulator::Now();
+    Time delay, arrival;
+    double rx_power_dBm;
+    
+    for (;it != signals.end();++it)
+    {
+        if (it->sender == phy)
+        {
+            continue;
+        }
+        
+        GetLink (it->sender, phy, it->tx_power_dBm, rx_power_dBm, delay);
+        arrival = it->start + delay;
+        
+        if (arrival > now)
+        {
+            if (!propagating)
             {
-                dst_id = 0;
+                continue;
             }
             
-            Simulator::ScheduleWithContext (dst_id, delay, &LoRaChannel::Receive, this, (*i), packet, rx_power_dBm, tx_freq_MHz, tx_sf, dur);
-        
-            m_packetSent(packet);
+            /*  still propagating so it can be received normally    */
+            Simulator::ScheduleWithContext (GetContext(phy), arrival - now, &LoRaChannel::Receive, this, phy, it->packet, rx_power_dBm, freq_MHz, it->sf, it->dur);
+        }
+        else if (arrival + it->dur > now)
+        {
+            phy->AddInterferer (it->packet, arrival, it->dur, it->sf, rx_power_dBm, freq_MHz);
         }
     }
     
     return;
 }
 
+void
+LoRaChannel::AddOnAirSignal (Ptr<LoRaPHY> sender, Ptr<Packet> packet, double tx_power_dBm, double tx_freq_MHz, uint8_t tx_sf, Time dur)
+{
+    std::deque<OnAirSignal> &signals = m_onAir[tx_freq_MHz];
+    Time now = Simulator::Now();
+    
+    /*  drop signals which ended well beyond any propagation delay  */
+    while (!signals.empty() && signals.front().start + signals.front().dur + Seconds(1) < now)
+    {
+        signals.pop_front();
+    }
+    
+    OnAirSignal signal;
+    signal.sender = sender;
+    signal.packet = packet;
+    signal.tx_power_dBm = tx_power_dBm;
+    signal.sf = tx_sf;
+    signal.start = now;
+    signal.dur = dur;
+    
+    signals.push_back(signal);
+    
+    return;
+}
+
 void
 LoRaChannel::Receive (Ptr<LoRaPHY> receiver, Ptr<Packet> packet, double rx_power_dBm, double rx_freq_MHz, uint8_t rx_sf, Time dur)
 {
@@ -222,7 +656,390 @@ LoRaChannel::Receive (Ptr<LoRaPHY> receiver, Ptr<Packet> packet, double rx_power
 double 
 LoRaChannel::GetRxPower (double tx_power_dBm, Ptr<MobilityModel> sender_mobility, Ptr<MobilityModel> receiver_mobility)
 {
-    return m_lossModel->CalcRxPower(tx_power_dBm, sender_mobility, receiver_mobility);
+    double rx_power_dBm = m_lossModel->CalcRxPower(tx_power_dBm, sender_mobility, receiver_mobility);
+    
+    if (m_stochasticLossModel)
+    {
+        rx_power_dBm = m_stochasticLossModel->CalcRxPower(rx_power_dBm, sender_mobility, receiver_mobility);
+    }
+    
+    return rx_power_dBm;
+}
+
+double
+LoRaChannel::GetMaxRange (double tx_power_dBm) const
+{
+    if (m_maxRange > 0)
+    {
+        return m_maxRange;
+    }
+    
+    if (!m_rangeDerived || m_minRxSens == std::numeric_limits<double>::max())
+    {
+        return -1;
+    }
+    
+    /*  invert L = L0 + 10 n log10(d/d0) for the largest tolerable loss  */
+    double budget = tx_power_dBm - (m_minRxSens - m_rangeMargin) - m_rangeRefLoss;
+    
+    return m_rangeRefDistance * std::pow(10, budget / (10 * m_rangeExponent));
+}
+
+void
+LoRaChannel::UpdateRangeBound (void)
+{
+    Ptr<LogDistancePropagationLossModel> logDistance = DynamicCast<LogDistancePropagationLossModel>(m_lossModel);
+    
+    /*  other models in the chain could add gain, so no bound is derived for them  */
+    m_rangeDerived = logDistance && !logDistance->GetNext() && !m_stochasticLossModel;
+    
+    if (!m_rangeDerived)
+    {
+        return;
+    }
+    
+    DoubleValue exponent, refDistance, refLoss;
+    logDistance->GetAttribute ("Exponent", exponent);
+    logDistance->GetAttribute ("ReferenceDistance", refDistance);
+    logDistance->GetAttribute ("ReferenceLoss", refLoss);
+    
+    m_rangeExponent = exponent.Get();
+    m_rangeRefDistance = refDistance.Get();
+    m_rangeRefLoss = refLoss.Get();
+    
+    return;
+}
+
+void
+LoRaChannel::NotifyRxSensChanged (double sens_dBm)
+{
+    /*  only ever lowered so the range bound stays conservative  */
+    if (sens_dBm < m_minRxSens)
+    {
+        m_minRxSens = sens_dBm;
+    }
+    
+    return;
+}
+
+int64_t
+LoRaChannel::GetCellKey (int64_t cx, int64_t cy) const
+{
+    /*  shift as unsigned since left shifting a negative value is undefined  */
+    return (int64_t)(((uint64_t)cx << 32) | ((uint64_t)cy & 0xFFFFFFFF));
+}
+
+void
+LoRaChannel::BuildGrid (double range)
+{
+    NS_LOG_FUNCTION (this << range);
+    
+    if (m_cellSize <= 0)
+    {
+        m_cellSize = range;
+    }
+    
+    m_gridBuilt = true;
+    m_lastRebin = Simulator::Now();
+    
+    std::deque<Ptr<LoRaPHY>>::iterator it = m_phyList.begin();
+    
+    for (;it != m_phyList.end();++it)
+    {
+        IndexPHY (*it);
+    }
+    
+    return;
+}
+
+void
+LoRaChannel::IndexPHY (Ptr<LoRaPHY> phy)
+{
+    Ptr<MobilityModel> mobility = phy->GetMobility();
+    std::vector<Ptr<LoRaPHY>>::iterator unindexed = std::find(m_unindexed.begin(), m_unindexed.end(), phy);
+    
+    if (!mobility)
+    {
+        /*  without a position the LoRaPHY cannot be placed in a cell, so every Send visits it  */
+        if (unindexed == m_unindexed.end())
+        {
+            m_unindexed.push_back(phy);
+        }
+        
+        return;
+    }
+    
+    if (unindexed != m_unindexed.end())
+    {
+        m_unindexed.erase(unindexed);
+    }
+    
+    std::map<Ptr<LoRaPHY>, int64_t>::iterator old = m_phyCell.find(phy);
+    
+    TrackPHY (phy);
+    
+    if (old != m_phyCell.end())
+    {
+        std::vector<Ptr<LoRaPHY>> &cell = m_grid[old->second];
+        
+        for (std::vector<Ptr<LoRaPHY>>::iterator it = cell.begin();it != cell.end();++it)
+        {
+            if ((*it) == phy)
+            {
+                cell.erase(it);
+                break;
+            }
+        }
+    }
+    
+    Vector3D pos = mobility->GetPosition();
+    int64_t key = GetCellKey((int64_t)std::floor(pos.x / m_cellSize), (int64_t)std::floor(pos.y / m_cellSize));
+    
+    m_grid[key].push_back(phy);
+    m_phyCell[phy] = key;
+    
+    /*  moving LoRaPHYs drift away from their cell between course changes    */
+    double speed = mobility->GetVelocity().GetLength();
+    
+    if (speed > 0)
+    {
+        m_mobileSpeed[phy] = speed;
+        m_maxSpeed = std::max(m_maxSpeed, speed);
+    }
+    else
+    {
+        m_mobileSpeed.erase(phy);
+    }
+    
+    return;
+}
+
+void
+LoRaChannel::UnindexPHY (Ptr<LoRaPHY> phy)
+{
+    std::vector<Ptr<LoRaPHY>>::iterator unindexed = std::find(m_unindexed.begin(), m_unindexed.end(), phy);
+    
+    if (unindexed != m_unindexed.end())
+    {
+        m_unindexed.erase(unindexed);
+    }
+    
+    std::map<Ptr<LoRaPHY>, int64_t>::iterator old = m_phyCell.find(phy);
+    
+    if (old == m_phyCell.end())
+    {
+        return;
+    }
+    
+    std::vector<Ptr<LoRaPHY>> &cell = m_grid[old->second];
+    
+    for (std::vector<Ptr<LoRaPHY>>::iterator it = cell.begin();it != cell.end();++it)
+    {
+        if ((*it) == phy)
+        {
+            cell.erase(it);
+            break;
+        }
+    }
+    
+    m_phyCell.erase(old);
+    m_mobileSpeed.erase(phy);
+    
+    return;
+}
+
+void
+LoRaChannel::RebinMobile (void)
+{
+    NS_LOG_FUNCTION (this);
+    
+    /*  copy since IndexPHY updates the set of moving LoRaPHYs  */
+    std::map<Ptr<LoRaPHY>, double> mobile = m_mobileSpeed;
+    std::map<Ptr<LoRaPHY>, double>::iterator it = mobile.begin();
+    
+    m_maxSpeed = 0;
+    
+    for (;it != mobile.end();++it)
+    {
+        IndexPHY (it->first);
+    }
+    
+    m_lastRebin = Simulator::Now();
+    
+    return;
+}
+
+void
+LoRaChannel::GetCachedLink (Ptr<LoRaPHY> sender, Ptr<LoRaPHY> receiver, double tx_power_dBm, double &rx_power_dBm, Time &delay)
+{
+    uint32_t s = TrackPHY (sender);
+    uint32_t r = TrackPHY (receiver);
+    
+    Ptr<MobilityModel> sender_mobility = sender->GetMobility();
+    Ptr<MobilityModel> receiver_mobility = receiver->GetMobility();
+    bool resample = m_stochasticLossModel && !m_freezeStochasticLoss;
+    
+    uint64_t key = ((uint64_t)s << 32) | r;
+    std::unordered_map<uint64_t, LinkBudget>::iterator it = m_links.find(key);
+    
+    if (it == m_links.end() || it->second.senderGen != m_generation[s] || it->second.receiverGen != m_generation[r])
+    {
+        LinkBudget link;
+        
+        link.senderGen = m_generation[s];
+        link.receiverGen = m_generation[r];
+        link.delay = m_delayModel->GetDelay(sender_mobility, receiver_mobility);
+        
+        if (resample)
+        {
+            /*  only cache the deterministic loss model */
+            link.loss_dB = tx_power_dBm - m_lossModel->CalcRxPower(tx_power_dBm, sender_mobility, receiver_mobility);
+        }
+        else
+        {
+            link.loss_dB = tx_power_dBm - GetRxPower (tx_power_dBm, sender_mobility, receiver_mobility);
+        }
+        
+        m_links[key] = link;
+        it = m_links.find(key);
+    }
+    
+    delay = it->second.delay;
+    rx_power_dBm = tx_power_dBm - it->second.loss_dB;
+    
+    if (resample)
+    {
+        /*  re-sample the stochastic loss model for this packet  */
+        rx_power_dBm = m_stochasticLossModel->CalcRxPower(rx_power_dBm, sender_mobility, receiver_mobility);
+    }
+    
+    return;
+}
+
+bool
+LoRaChannel::IsStationary (Ptr<LoRaPHY> phy) const
+{
+    /*  moving nodes change position without firing course changes  */
+    Vector3D velocity = phy->GetMobility()->GetVelocity();
+    
+    return (velocity.x == 0 && velocity.y == 0 && velocity.z == 0);
+}
+
+uint32_t
+LoRaChannel::TrackPHY (Ptr<LoRaPHY> phy)
+{
+    std::unordered_map<const LoRaPHY *, uint32_t>::iterator it = m_phySlot.find(PeekPointer(phy));
+    
+    if (it != m_phySlot.end())
+    {
+        return it->second;
+    }
+    
+    uint32_t slot = m_generation.size();
+    
+    m_generation.push_back(0);
+    m_phySlot[PeekPointer(phy)] = slot;
+    
+    phy->GetMobility()->TraceConnectWithoutContext ("CourseChange", MakeBoundCallback(&LoRaChannel::CourseChanged, this, PeekPointer(phy)));
+    
+    return slot;
+}
+
+void
+LoRaChannel::UntrackPHY (Ptr<LoRaPHY> phy)
+{
+    std::unordered_map<const LoRaPHY *, uint32_t>::iterator it = m_phySlot.find(PeekPointer(phy));
+    
+    if (it == m_phySlot.end())
+    {
+        return;
+    }
+    
+    /*  invalidate any cached links, the slot itself is not reused  */
+    m_generation[it->second]++;
+    m_phySlot.erase(it);
+    
+    if (phy->GetMobility())
+    {
+        phy->GetMobility()->TraceDisconnectWithoutContext ("CourseChange", MakeBoundCallback(&LoRaChannel::CourseChanged, this, PeekPointer(phy)));
+    }
+    
+    return;
+}
+
+void
+LoRaChannel::CourseChanged (LoRaChannel *channel, LoRaPHY *phy, Ptr<const MobilityModel> mobility)
+{
+    std::unordered_map<const LoRaPHY *, uint32_t>::iterator it = channel->m_phySlot.find(phy);
+    
+    if (it != channel->m_phySlot.end())
+    {
+        /*  invalidates every cached link to or from this LoRaPHY    */
+        channel->m_generation[it->second]++;
+    }
+    
+    if (channel->m_gridBuilt)
+    {
+        channel->IndexPHY (Ptr<LoRaPHY>(phy));
+    }
+    
+    return;
+}
+
+void
+LoRaChannel::SetCollisionMatrix (LoraInterferenceHelper::CollisionMatrix matrix)
+{
+    m_collisionMatrix = matrix;
+    
+    /*  CUSTOM keeps whatever SetCustomCollisionMatrix last copied in   */
+    if (matrix != LoraInterferenceHelper::CUSTOM)
+    {
+        m_collisionSnir = *LoraInterferenceHelper::GetCollisionSnir (matrix);
+    }
+    
+    return;
+}
+
+LoraInterferenceHelper::CollisionMatrix
+LoRaChannel::GetCollisionMatrix (void) const
+{
+    return m_collisionMatrix;
+}
+
+void
+LoRaChannel::SetCustomCollisionMatrix (const std::vector<std::vector<double>> &snir_dB)
+{
+    std::size_t n = snir_dB.size ();
+    
+    NS_ABORT_MSG_UNLESS (n == 7 || n == 6, "Collision matrix must be 7x7 (SF6 to SF12) or 6x6 (SF7 to SF12)");
+    
+    /*  a 6x6 matrix keeps the SF6 row and column of the Goursaud matrix    */
+    if (n == 6)
+    {
+        m_collisionSnir = LoraInterferenceHelper::collisionSnirGoursaud;
+    }
+    
+    std::size_t offset = 7 - n;
+    
+    for (std::size_t i = 0; i < n; i++)
+    {
+        NS_ABORT_MSG_UNLESS (snir_dB[i].size () == n, "Collision matrix must be square");
+        
+        for (std::size_t j = 0; j < n; j++)
+        {
+            m_collisionSnir.dB[i + offset][j + offset] = snir_dB[i][j];
+            m_collisionSnir.linear[i + offset][j + offset] = std::pow (10.0, snir_dB[i][j] / 10.0);
+        }
+    }
+    
+    m_collisionMatrix = LoraInterferenceHelper::CUSTOM;
+    return;
+}
+
+const LoraInterferenceHelper::CollisionSnir *
+LoRaChannel::GetCollisionSnir (void) const
+{
+    return &m_collisionSnir;
 }
 
 }
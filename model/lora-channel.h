@@ -35,9 +35,13 @@
 
 #include "ns3/lora-phy.h"
 #include "ns3/lora-net-device.h"
+#include "ns3/lora-interference-helper.h"
 
 #include <deque>
 #include <iterator>
+#include <map>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3 {
 namespace lora_mesh {
@@ -70,6 +74,15 @@ public:
      */
     void AddPHY (Ptr<LoRaPHY> phy);
     
+    /**
+     *  Attaches a set of LoRaPHYs to the channel at once. The LoRaPHYs are sorted by node id and
+     *  merged with the attached ones in a single pass, keeping the node id order AddPHY maintains
+     *  without its linear search per LoRaPHY. LoRaPHYs without a node are attached last.
+     * 
+     *  \param  phys    the LoRaPHYs to be attached to the channel
+     */
+    void AddPHYs (const std::vector<Ptr<LoRaPHY>> &phys);
+    
     /**
      *  Removes LoRaPHY from the channel, no longer allowing for the transmission and 
      *  reception of packets to and from other LoRaPHYs which are attached to this channel.
@@ -92,6 +105,20 @@ public:
      */
     Ptr<PropagationLossModel> GetLossModel (void) const;
     
+    /**
+     *  Sets a PropagationLossModel applied after the loss model of the channel. With a static
+     *  topology, its loss is either cached or re-sampled for every packet depending on the
+     *  FreezeStochasticLoss attribute, while the loss model of the channel is always cached.
+     * 
+     *  \param loss pointer to the stochastic PropagationLossModel, or null for none
+     */
+    void SetStochasticLossModel (Ptr<PropagationLossModel> loss);
+    
+    /**
+     *  \return pointer to the stochastic PropagationLossModel of the channel, null if none
+     */
+    Ptr<PropagationLossModel> GetStochasticLossModel (void) const;
+    
     /**
      *  Sets the PropagationDelayModel to be used for this channel.
      * 
@@ -132,12 +159,291 @@ public:
      */
     double GetRxPower (double tx_power_dBm, Ptr<MobilityModel> sender_mobility, Ptr<MobilityModel> receiver_mobility); 
     
+    /**
+     *  Computes a conservative upper bound on the distance a signal transmitted with the given
+     *  power can travel before it falls below the lowest receiver sensitivity on the channel
+     *  (less the range margin). The bound is either the user supplied MaxRange attribute or,
+     *  when the loss model is a single LogDistancePropagationLossModel with no other model
+     *  chained to it and no stochastic loss model, derived from its parameters as they were
+     *  when the loss model was set.
+     * 
+     *  \param  tx_power_dBm    power (in dBm) the packet is transmitted with
+     * 
+     *  \return the maximum range (in m), or a negative value if no bound can be derived
+     */
+    double GetMaxRange (double tx_power_dBm) const;
+    
+    /**
+     *  Informs the channel that the sensitivity of one of its attached LoRaPHYs has changed so
+     *  that the range bound used by the spatial index stays conservative.
+     * 
+     *  \param  sens_dBm    the new receiver sensitivity (dBm)
+     */
+    void NotifyRxSensChanged (double sens_dBm);
+    
+    /**
+     *  Informs the channel that one of its attached LoRaPHYs now listens on another frequency,
+     *  moving it to the matching frequency bucket and delivering the signals already on air on
+     *  that frequency to it.
+     * 
+     *  \param  phy         the LoRaPHY whose receive frequency changed
+     *  \param  freq_MHz    the new receive frequency (MHz)
+     */
+    void NotifyRxFreqChanged (Ptr<LoRaPHY> phy, double freq_MHz);
+    
+    /**
+     *  Informs the channel that one of its attached LoRaPHYs ignores signals while asleep, so
+     *  that the signals on air are recorded for it to pick up on waking up.
+     */
+    void NotifyLazyInterference (void);
+    
+    /**
+     *  Delivers the signals currently on air on the given frequency to a LoRaPHY which missed
+     *  them. Signals already arriving at the LoRaPHY are only registered as interference. The
+     *  signals on air are recorded when frequency buckets are enabled or a LoRaPHY with lazy 
+     *  interference is attached, otherwise there is nothing to deliver.
+     * 
+     *  \param  phy         the LoRaPHY which missed the signals
+     *  \param  freq_MHz    the frequency (MHz) the LoRaPHY listens on
+     *  \param  propagating whether signals which have not reached the LoRaPHY yet are also
+     *                      delivered, for a LoRaPHY the channel never scheduled them for
+     */
+    void ReplayOnAirSignals (Ptr<LoRaPHY> phy, double freq_MHz, bool propagating);
+    
+    /**
+     *  Selects one of the predefined collision matrices used by the LoRaPHYs on the channel
+     * 
+     *  \param  matrix  GOURSAUD or ALOHA (CUSTOM keeps the last matrix set by SetCustomCollisionMatrix)
+     */
+    void SetCollisionMatrix (LoraInterferenceHelper::CollisionMatrix matrix);
+    
+    /**
+     *  \return the collision matrix currently used by the channel
+     */
+    LoraInterferenceHelper::CollisionMatrix GetCollisionMatrix (void) const;
+    
+    /**
+     *  Sets a user supplied collision matrix for the LoRaPHYs on the channel
+     * 
+     *  \param  snir_dB     7x7 isolation matrix (in dB), indexed by [signal SF - 6][interferer SF - 6],
+     *                      or 6x6 indexed by [signal SF - 7][interferer SF - 7] keeping the SF6 row
+     *                      and column of the Goursaud matrix
+     */
+    void SetCustomCollisionMatrix (const std::vector<std::vector<double>> &snir_dB);
+    
+    /**
+     *  \return the collision matrix shared by the LoRaPHYs on the channel, valid for the
+     *  lifetime of the channel
+     */
+    const LoraInterferenceHelper::CollisionSnir *GetCollisionSnir (void) const;
+    
 private:
     Ptr<PropagationLossModel> m_lossModel;
+    Ptr<PropagationLossModel> m_stochasticLossModel;
     Ptr<PropagationDelayModel> m_delayModel;
     
     std::deque<Ptr<LoRaPHY>> m_phyList;
     
+    /*  spatial index settings  */
+    bool    m_spatialIndex;
+    double  m_maxRange;
+    double  m_rangeMargin;
+    double  m_cellSize;
+    
+    /*  collision matrix shared by the LoRaPHYs attached to the channel  */
+    LoraInterferenceHelper::CollisionMatrix m_collisionMatrix;
+    LoraInterferenceHelper::CollisionSnir   m_collisionSnir;
+    
+    /*  lowest sensitivity (dBm) of the LoRaPHYs attached to the channel    */
+    double  m_minRxSens;
+    
+    /*  parameters of the loss model used to derive the range bound  */
+    bool    m_rangeDerived;
+    double  m_rangeExponent;
+    double  m_rangeRefDistance;
+    double  m_rangeRefLoss;
+    
+    /*  LoRaPHYs grouped by the frequency they listen on    */
+    bool m_frequencyBuckets;
+    bool m_bucketsDirty;
+    std::map<double, std::vector<Ptr<LoRaPHY>>> m_freqBuckets;
+    
+    /*  a signal recently sent on the channel    */
+    struct OnAirSignal
+    {
+        Ptr<LoRaPHY>    sender;
+        Ptr<Packet>     packet;
+        double          tx_power_dBm;
+        uint8_t         sf;
+        Time            start;
+        Time            dur;
+    };
+    
+    /*  signals recently sent on each frequency, oldest first   */
+    std::map<double, std::deque<OnAirSignal>> m_onAir;
+    
+    /*  whether signals on air are recorded for LoRaPHYs with lazy interference  */
+    bool m_recordOnAir;
+    
+    /*  static topology (cached link budget) settings   */
+    bool    m_staticTopology;
+    bool    m_freezeStochasticLoss;
+    
+    /*  cached loss and delay for a (sender, receiver) pair  */
+    struct LinkBudget
+    {
+        double      loss_dB;
+        Time        delay;
+        uint32_t    senderGen;      /*  generations of the two LoRaPHYs when cached */
+        uint32_t    receiverGen;
+    };
+    
+    /*  sparse link budget matrix keyed by packed (sender, receiver) slots   */
+    std::unordered_map<uint64_t, LinkBudget> m_links;
+    
+    /*  slot of each LoRaPHY whose mobility is being tracked, and its position generation   */
+    std::unordered_map<const LoRaPHY *, uint32_t> m_phySlot;
+    std::vector<uint32_t> m_generation;
+    
+    /*  uniform grid of LoRaPHYs keyed by packed (x, y) cell coordinates    */
+    bool m_gridBuilt;
+    std::unordered_map<int64_t, std::vector<Ptr<LoRaPHY>>> m_grid;
+    std::map<Ptr<LoRaPHY>, int64_t> m_phyCell;
+    
+    /*  LoRaPHYs without a MobilityModel, which are visited by every Send on the grid   */
+    std::vector<Ptr<LoRaPHY>> m_unindexed;
+    
+    /*  LoRaPHYs which were moving at their last course change, and the bound on their drift  */
+    std::map<Ptr<LoRaPHY>, double> m_mobileSpeed;
+    double  m_maxSpeed;
+    Time    m_lastRebin;
+    
+    /**
+     *  Gets the received power and propagation delay of a link
+     * 
+     *  \param  sender          the LoRaPHY sending the packet
+     *  \param  receiver        the LoRaPHY receiving the packet
+     *  \param  tx_power_dBm    power (in dBm) the packet was transmitted with
+     *  \param  rx_power_dBm    set to the power (in dBm) of the packet's signal at the receiver
+     *  \param  delay           set to the time it takes the packet to arrive at the receiver
+     */
+    void GetLink (Ptr<LoRaPHY> sender, Ptr<LoRaPHY> receiver, double tx_power_dBm, double &rx_power_dBm, Time &delay);
+    
+    /**
+     *  Gets the simulation context (node ID) of a receiving LoRaPHY
+     * 
+     *  \param  receiver    the LoRaPHY receiving the packet
+     * 
+     *  \return the node ID of the receiver, 0 if it has no node
+     */
+    uint32_t GetContext (Ptr<LoRaPHY> receiver) const;
+    
+    /**
+     *  Gets the LoRaPHYs listening on a frequency, rebuilding the buckets if needed
+     * 
+     *  \param  freq_MHz    the frequency (MHz)
+     * 
+     *  \return the LoRaPHYs listening on the frequency, in node id order
+     */
+    const std::vector<Ptr<LoRaPHY>> &GetFrequencyBucket (double freq_MHz);
+    
+    /**
+     *  Records a signal as being on air so LoRaPHYs tuning to its frequency later still see it
+     */
+    void AddOnAirSignal (Ptr<LoRaPHY> sender, Ptr<Packet> packet, double tx_power_dBm, double tx_freq_MHz, uint8_t tx_sf, Time dur);
+    
+    /**
+     *  Gets the received power and propagation delay of a link, from the link budget matrix 
+     *  if the cached entry is still valid, computing and caching it otherwise
+     * 
+     *  \param  sender          the LoRaPHY sending the packet
+     *  \param  receiver        the LoRaPHY receiving the packet
+     *  \param  tx_power_dBm    power (in dBm) the packet was transmitted with
+     *  \param  rx_power_dBm    set to the power (in dBm) of the packet's signal at the receiver
+     *  \param  delay           set to the time it takes the packet to arrive at the receiver
+     */
+    void GetCachedLink (Ptr<LoRaPHY> sender, Ptr<LoRaPHY> receiver, double tx_power_dBm, double &rx_power_dBm, Time &delay);
+    
+    /**
+     *  Checks whether a LoRaPHY is currently not moving, in which case its links can be cached
+     * 
+     *  \param  phy the LoRaPHY to be checked
+     * 
+     *  \return true if the LoRaPHY's velocity is zero, false otherwise
+     */
+    bool IsStationary (Ptr<LoRaPHY> phy) const;
+    
+    /**
+     *  Assigns a slot to a LoRaPHY and starts following the course changes of its mobility 
+     *  model, if not already done
+     * 
+     *  \param  phy the LoRaPHY to be tracked
+     * 
+     *  \return the slot of the LoRaPHY
+     */
+    uint32_t TrackPHY (Ptr<LoRaPHY> phy);
+    
+    /**
+     *  Stops following the course changes of a LoRaPHY's mobility model
+     * 
+     *  \param  phy the LoRaPHY no longer to be tracked
+     */
+    void UntrackPHY (Ptr<LoRaPHY> phy);
+    
+    /**
+     *  Builds the spatial grid from all LoRaPHYs currently attached to the channel
+     * 
+     *  \param  range   the range (in m) used to size the cells if no cell size was given
+     */
+    void BuildGrid (double range);
+    
+    /**
+     *  Places a LoRaPHY in the grid cell matching its current position, removing it from the
+     *  cell it was previously in
+     * 
+     *  \param  phy the LoRaPHY to be (re)indexed
+     */
+    void IndexPHY (Ptr<LoRaPHY> phy);
+    
+    /**
+     *  Removes a LoRaPHY from the spatial grid
+     * 
+     *  \param  phy the LoRaPHY to be removed
+     */
+    void UnindexPHY (Ptr<LoRaPHY> phy);
+    
+    /**
+     *  Re-indexes all moving LoRaPHYs at their current positions, resetting the drift bound
+     */
+    void RebinMobile (void);
+    
+    /**
+     *  Packs the coordinates of a grid cell into the key used by the grid
+     * 
+     *  \param  cx  the x coordinate of the cell
+     *  \param  cy  the y coordinate of the cell
+     * 
+     *  \return the packed cell key
+     */
+    int64_t GetCellKey (int64_t cx, int64_t cy) const;
+    
+    /**
+     *  Reads the parameters used to derive the range bound from the loss model, if it is
+     *  a single LogDistancePropagationLossModel
+     */
+    void UpdateRangeBound (void);
+    
+    /**
+     *  Schedules the reception of a packet at a single LoRaPHY
+     */
+    void SendToPHY (Ptr<LoRaPHY> sender, Ptr<LoRaPHY> receiver, Ptr<Packet> packet, double tx_power_dBm, double tx_freq_MHz, uint8_t tx_sf, Time dur);
+    
+    /**
+     *  Callback connected to the "CourseChange" trace source of each tracked LoRaPHY's 
+     *  MobilityModel, used to keep the spatial grid and link budget matrix up to date
+     */
+    static void CourseChanged (LoRaChannel *channel, LoRaPHY *phy, Ptr<const MobilityModel> mobility);
+    
     /**
      *  Interfaces with the LoRaPHY device receiving the packet passing the necessary parameters
      * 
@@ -21,6 +21,8 @@
 #include "ns3/lora-interference-helper.h"
 #include "ns3/log.h"
 #include "ns3/enum.h"
+#include "ns3/abort.h"
+#include <cmath>
 #include <limits>
 
 namespace ns3 {
@@ -32,6 +34,99 @@ NS_LOG_COMPONENT_DEFINE ("LoraInterferenceHelper");
  *    LoraInterferenceHelper::Event    *
  ***************************************/
 
+// Event pool
+// Freed events are chained through their own storage, blocks are kept for
+// the rest of the simulation since the pool only ever grows to the peak
+// number of live events. The simulator runs on a single thread, so the pool
+// is shared without locking.
+static const uint32_t EVENT_POOL_BLOCK = 256;
+
+union EventPoolSlot
+{
+  EventPoolSlot *next;
+  alignas (LoraInterferenceHelper::Event) char storage[sizeof (LoraInterferenceHelper::Event)];
+};
+
+static EventPoolSlot *g_eventFreeList = 0;
+static std::vector<EventPoolSlot *> g_eventPoolBlocks;
+static uint32_t g_eventsLive = 0;
+static bool g_eventPoolEnabled = true;
+
+void *
+LoraInterferenceHelper::Event::operator new (size_t size)
+{
+  NS_ASSERT (size == sizeof (LoraInterferenceHelper::Event));
+
+  g_eventsLive++;
+
+  if (!g_eventPoolEnabled)
+    {
+      return ::operator new (size);
+    }
+
+  if (g_eventFreeList == 0)
+    {
+      EventPoolSlot *block = static_cast<EventPoolSlot *> (
+          ::operator new (EVENT_POOL_BLOCK * sizeof (EventPoolSlot)));
+      g_eventPoolBlocks.push_back (block);
+
+      for (uint32_t i = 0; i < EVENT_POOL_BLOCK; i++)
+        {
+          block[i].next = g_eventFreeList;
+          g_eventFreeList = &block[i];
+        }
+    }
+
+  EventPoolSlot *slot = g_eventFreeList;
+  g_eventFreeList = slot->next;
+
+  return slot;
+}
+
+void
+LoraInterferenceHelper::Event::operator delete (void *p)
+{
+  if (p == 0)
+    {
+      return;
+    }
+
+  g_eventsLive--;
+
+  if (!g_eventPoolEnabled)
+    {
+      ::operator delete (p);
+      return;
+    }
+
+  EventPoolSlot *slot = static_cast<EventPoolSlot *> (p);
+  slot->next = g_eventFreeList;
+  g_eventFreeList = slot;
+}
+
+void
+LoraInterferenceHelper::Event::SetPoolEnabled (bool enabled)
+{
+  // Events are released to where they would be allocated from now, so a live
+  // event would end up in the wrong place
+  NS_ABORT_MSG_IF (enabled != g_eventPoolEnabled && g_eventsLive != 0,
+                   "Event pool can only be toggled while no events are alive (" << g_eventsLive << " alive)");
+
+  g_eventPoolEnabled = enabled;
+}
+
+uint32_t
+LoraInterferenceHelper::Event::GetPoolCapacity (void)
+{
+  return g_eventPoolBlocks.size () * EVENT_POOL_BLOCK;
+}
+
+uint32_t
+LoraInterferenceHelper::Event::GetNLiveEvents (void)
+{
+  return g_eventsLive;
+}
+
 // Event Constructor
 LoraInterferenceHelper::Event::Event (Time duration, double rxPowerdBm, uint8_t spreadingFactor,
                                       Ptr<Packet> packet, double frequencyMHz)
@@ -39,12 +134,26 @@ LoraInterferenceHelper::Event::Event (Time duration, double rxPowerdBm, uint8_t
       m_endTime (m_startTime + duration),
       m_sf (spreadingFactor),
       m_rxPowerdBm (rxPowerdBm),
+      m_rxPowermW (pow (10, rxPowerdBm / 10)),
       m_packet (packet),
       m_frequencyMHz (frequencyMHz)
 {
   // NS_LOG_FUNCTION_NOARGS ();
 }
 
+LoraInterferenceHelper::Event::Event (Time startTime, Time duration, double rxPowerdBm,
+                                      uint8_t spreadingFactor, Ptr<Packet> packet,
+                                      double frequencyMHz)
+    : m_startTime (startTime),
+      m_endTime (m_startTime + duration),
+      m_sf (spreadingFactor),
+      m_rxPowerdBm (rxPowerdBm),
+      m_rxPowermW (pow (10, rxPowerdBm / 10)),
+      m_packet (packet),
+      m_frequencyMHz (frequencyMHz)
+{
+}
+
 // Event Destructor
 LoraInterferenceHelper::Event::~Event ()
 {
@@ -76,6 +185,12 @@ LoraInterferenceHelper::Event::GetRxPowerdBm (void) const
   return m_rxPowerdBm;
 }
 
+double
+LoraInterferenceHelper::Event::GetRxPowermW (void) const
+{
+  return m_rxPowermW;
+}
+
 uint8_t
 LoraInterferenceHelper::Event::GetSpreadingFactor (void) const
 {
@@ -112,55 +227,46 @@ operator<< (std::ostream &os, const LoraInterferenceHelper::Event &event)
 /****************************
  *  LoraInterferenceHelper  *
  ****************************/
-// This collision matrix can be used for comparisons with the performance of Aloha
-// systems, where collisions imply the loss of both packets.
-double inf = std::numeric_limits<double>::max ();
-std::vector<std::vector<double>> LoraInterferenceHelper::collisionSnirAloha= {
-    //   7   8   9  10  11  12
-    {inf, -inf, -inf, -inf, -inf, -inf}, // SF7
-    {-inf, inf, -inf, -inf, -inf, -inf}, // SF8
-    {-inf, -inf, inf, -inf, -inf, -inf}, // SF9
-    {-inf, -inf, -inf, inf, -inf, -inf}, // SF10
-    {-inf, -inf, -inf, -inf, inf, -inf}, // SF11
-    {-inf, -inf, -inf, -inf, -inf, inf} // SF12
-};
+constexpr double LoraInterferenceHelper::infSnir;
+constexpr double LoraInterferenceHelper::infLinear;
+
+// The ALOHA collision matrix can be used for comparisons with the performance
+// of Aloha systems, where collisions imply the loss of both packets.
+constexpr LoraInterferenceHelper::CollisionSnir LoraInterferenceHelper::collisionSnirAloha;
 
 // LoRa Collision Matrix (Goursaud)
 // Values are inverted w.r.t. the paper since here we interpret this as an
 // _isolation_ matrix instead of a cochannel _rejection_ matrix like in
 // Goursaud's paper.
-  std::vector<std::vector<double>> LoraInterferenceHelper::collisionSnirGoursaud= {
-    // SF7  SF8  SF9  SF10 SF11 SF12
-    {6, -16, -18, -19, -19, -20}, // SF7
-    {-24, 6, -20, -22, -22, -22}, // SF8
-    {-27, -27, 6, -23, -25, -25}, // SF9
-    {-30, -30, -30, 6, -26, -28}, // SF10
-    {-33, -33, -33, -33, 6, -29}, // SF11
-    {-36, -36, -36, -36, -36, 6} // SF12
-};
+constexpr LoraInterferenceHelper::CollisionSnir LoraInterferenceHelper::collisionSnirGoursaud;
 
 LoraInterferenceHelper::CollisionMatrix LoraInterferenceHelper::collisionMatrix =
     LoraInterferenceHelper::GOURSAUD;
 
 NS_OBJECT_ENSURE_REGISTERED (LoraInterferenceHelper);
 
-void
-LoraInterferenceHelper::SetCollisionMatrix (
+const LoraInterferenceHelper::CollisionSnir *
+LoraInterferenceHelper::GetCollisionSnir (
     enum LoraInterferenceHelper::CollisionMatrix collisionMatrix)
 {
   switch (collisionMatrix)
     {
     case LoraInterferenceHelper::ALOHA:
-      NS_LOG_DEBUG ("Setting the ALOHA collision matrix");
-      m_collisionSnir = LoraInterferenceHelper::collisionSnirAloha;
-      break;
+      return &LoraInterferenceHelper::collisionSnirAloha;
     case LoraInterferenceHelper::GOURSAUD:
-      NS_LOG_DEBUG ("Setting the GOURSAUD collision matrix");
-      m_collisionSnir = LoraInterferenceHelper::collisionSnirGoursaud;
-      break;
+    default:
+      return &LoraInterferenceHelper::collisionSnirGoursaud;
     }
 }
 
+void
+LoraInterferenceHelper::SetCollisionSnir (const LoraInterferenceHelper::CollisionSnir *collisionSnir)
+{
+  NS_LOG_FUNCTION (this << collisionSnir);
+
+  m_collisionSnir = collisionSnir;
+}
+
 TypeId
 LoraInterferenceHelper::GetTypeId (void)
 {
@@ -170,11 +276,13 @@ LoraInterferenceHelper::GetTypeId (void)
   return tid;
 }
 
-  LoraInterferenceHelper::LoraInterferenceHelper () : m_collisionSnir(LoraInterferenceHelper::collisionSnirGoursaud)
+  LoraInterferenceHelper::LoraInterferenceHelper () : m_collisionSnir (GetCollisionSnir (collisionMatrix)),
+                                                       m_events (16),
+                                                       m_head (0),
+                                                       m_nEvents (0),
+                                                       m_maxDuration (Seconds (0))
 {
   NS_LOG_FUNCTION (this);
-
-  SetCollisionMatrix (collisionMatrix);
 }
 
 LoraInterferenceHelper::~LoraInterferenceHelper ()
@@ -196,41 +304,129 @@ LoraInterferenceHelper::Add (Time duration, double rxPower, uint8_t spreadingFac
   Ptr<LoraInterferenceHelper::Event> event = Create<LoraInterferenceHelper::Event> (
       duration, rxPower, spreadingFactor, packet, frequencyMHz);
 
-  // Add the event to the list
-  m_events.push_back (event);
+  // Expire old events and add the new one to the buffer
+  CleanOldEvents ();
+  InsertEvent (event);
 
-  // Clean the event list
-  if (m_events.size () > 100)
-    {
-      CleanOldEvents ();
-    }
+  return event;
+}
+
+Ptr<LoraInterferenceHelper::Event>
+LoraInterferenceHelper::Add (Time startTime, Time duration, double rxPower,
+                             uint8_t spreadingFactor, Ptr<Packet> packet, double frequencyMHz)
+{
+  NS_LOG_FUNCTION (this << startTime.GetSeconds () << duration.GetSeconds () << rxPower
+                        << unsigned(spreadingFactor) << packet << frequencyMHz);
+
+  Ptr<LoraInterferenceHelper::Event> event = Create<LoraInterferenceHelper::Event> (
+      startTime, duration, rxPower, spreadingFactor, packet, frequencyMHz);
+
+  CleanOldEvents ();
+  InsertEvent (event);
 
   return event;
 }
 
+Ptr<LoraInterferenceHelper::Event> &
+LoraInterferenceHelper::EventAt (uint32_t i)
+{
+  return m_events[(m_head + i) & (m_events.size () - 1)];
+}
+
 void
-LoraInterferenceHelper::CleanOldEvents (void)
+LoraInterferenceHelper::InsertEvent (Ptr<LoraInterferenceHelper::Event> event)
 {
-  NS_LOG_FUNCTION (this);
+  // Grow the buffer when full, unrolling it so that the oldest event is first
+  if (m_nEvents == m_events.size ())
+    {
+      std::vector<Ptr<LoraInterferenceHelper::Event>> events (m_events.size () * 2);
+
+      for (uint32_t i = 0; i < m_nEvents; i++)
+        {
+          events[i] = EventAt (i);
+        }
+
+      m_events.swap (events);
+      m_head = 0;
+    }
+
+  if (event->GetDuration () > m_maxDuration)
+    {
+      m_maxDuration = event->GetDuration ();
+    }
+
+  // Events are almost always added in start time order, so shift from the back
+  uint32_t i = m_nEvents;
+  m_nEvents++;
 
-  // Cycle the events, and clean up if an event is old.
-  for (auto it = m_events.begin (); it != m_events.end ();)
+  while (i > 0 && EventAt (i - 1)->GetStartTime () > event->GetStartTime ())
     {
-      if ((*it)->GetEndTime () + oldEventThreshold < Simulator::Now ())
+      EventAt (i) = EventAt (i - 1);
+      i--;
+    }
+
+  EventAt (i) = event;
+}
+
+uint32_t
+LoraInterferenceHelper::LowerBound (Time time)
+{
+  uint32_t first = 0;
+  uint32_t count = m_nEvents;
+
+  while (count > 0)
+    {
+      uint32_t step = count / 2;
+
+      if (EventAt (first + step)->GetStartTime () < time)
         {
-          it = m_events.erase (it);
+          first += step + 1;
+          count -= step + 1;
         }
       else
         {
-          it++;
+          count = step;
         }
     }
+
+  return first;
+}
+
+void
+LoraInterferenceHelper::CleanOldEvents (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // An event can only be needed while a reception it overlaps is ongoing, so
+  // never expire events younger than the longest duration seen
+  Time threshold = std::max (oldEventThreshold, m_maxDuration);
+
+  // Pop expired events from the front of the buffer
+  while (m_nEvents > 0 && EventAt (0)->GetEndTime () + threshold < Simulator::Now ())
+    {
+      EventAt (0) = Ptr<LoraInterferenceHelper::Event> ();
+      m_head = (m_head + 1) & (m_events.size () - 1);
+      m_nEvents--;
+    }
+}
+
+uint32_t
+LoraInterferenceHelper::GetNEvents (void) const
+{
+  return m_nEvents;
 }
 
 std::list<Ptr<LoraInterferenceHelper::Event>>
 LoraInterferenceHelper::GetInterferers ()
 {
-  return m_events;
+  std::list<Ptr<LoraInterferenceHelper::Event>> interferers;
+
+  for (uint32_t i = 0; i < m_nEvents; i++)
+    {
+      interferers.push_back (EventAt (i));
+    }
+
+  return interferers;
 }
 
 void
@@ -240,9 +436,9 @@ LoraInterferenceHelper::PrintEvents (std::ostream &stream)
 
   stream << "Currently registered events:" << std::endl;
 
-  for (auto it = m_events.begin (); it != m_events.end (); it++)
+  for (uint32_t i = 0; i < m_nEvents; i++)
     {
-      (*it)->Print (stream);
+      EventAt (i)->Print (stream);
       stream << std::endl;
     }
 }
@@ -252,34 +448,38 @@ LoraInterferenceHelper::IsDestroyedByInterference (Ptr<LoraInterferenceHelper::E
 {
   NS_LOG_FUNCTION (this << event);
 
-  NS_LOG_INFO ("Current number of events in LoraInterferenceHelper: " << m_events.size ());
+  NS_LOG_INFO ("Current number of events in LoraInterferenceHelper: " << m_nEvents);
 
   // We want to see the interference affecting this event: cycle through events
   // that overlap with this one and see whether it survives the interference or
   // not.
 
   // Gather information about the event
-  double rxPowerDbm = event->GetRxPowerdBm ();
+  double rxPowermW = event->GetRxPowermW ();
   uint8_t sf = event->GetSpreadingFactor ();
   double frequency = event->GetFrequency ();
 
+  NS_ABORT_MSG_IF (sf < 6 || sf > 12, "No collision matrix entries for SF" << unsigned(sf));
+
   // Handy information about the time frame when the packet was received
   Time now = Simulator::Now ();
   Time duration = event->GetDuration ();
   Time packetStartTime = now - duration;
   Time packetEndTime = now;
 
-  // Get the list of interfering events
-  std::list<Ptr<LoraInterferenceHelper::Event>>::iterator it;
+  // Only events starting in (packetStartTime - m_maxDuration, packetEndTime)
+  // can overlap with this one
+  uint32_t first = LowerBound (packetStartTime - m_maxDuration);
+  uint32_t last = LowerBound (packetEndTime);
 
-  // Energy for interferers of various SFs
-  std::vector<double> cumulativeInterferenceEnergy (6, 0);
+  // Energy [mW s] for interferers of various SFs (SF6 to SF12)
+  double cumulativeInterferenceEnergy[7] = {0, 0, 0, 0, 0, 0, 0};
 
   // Cycle over the events
-  for (it = m_events.begin (); it != m_events.end ();)
+  for (uint32_t i = first; i < last; i++)
     {
       // Pointer to the current interferer
-      Ptr<LoraInterferenceHelper::Event> interferer = *it;
+      const Ptr<LoraInterferenceHelper::Event> &interferer = EventAt (i);
 
       // Only consider the current event if the channel is the same: we
       // assume there's no interchannel interference. Also skip the current
@@ -287,7 +487,6 @@ LoraInterferenceHelper::IsDestroyedByInterference (Ptr<LoraInterferenceHelper::E
       if (!(interferer->GetFrequency () == frequency) || interferer == event)
         {
           NS_LOG_DEBUG ("Different channel or same event");
-          it++;
           continue; // Continues from the first line inside the for cycle
         }
 
@@ -295,63 +494,67 @@ LoraInterferenceHelper::IsDestroyedByInterference (Ptr<LoraInterferenceHelper::E
 
       // Gather information about this interferer
       uint8_t interfererSf = interferer->GetSpreadingFactor ();
-      double interfererPower = interferer->GetRxPowerdBm ();
-      Time interfererStartTime = interferer->GetStartTime ();
-      Time interfererEndTime = interferer->GetEndTime ();
+
+      NS_ABORT_MSG_IF (interfererSf < 6 || interfererSf > 12,
+                       "No collision matrix entries for SF" << unsigned(interfererSf));
 
       NS_LOG_INFO ("Found an interferer: sf = " << unsigned(interfererSf)
-                                                << ", power = " << interfererPower
-                                                << ", start time = " << interfererStartTime
-                                                << ", end time = " << interfererEndTime);
+                                                << ", power = " << interferer->GetRxPowerdBm ()
+                                                << ", start time = " << interferer->GetStartTime ()
+                                                << ", end time = " << interferer->GetEndTime ());
 
       // Compute the fraction of time the two events are overlapping
       Time overlap = GetOverlapTime (event, interferer);
 
       NS_LOG_DEBUG ("The two events overlap for " << overlap.GetSeconds () << " s.");
 
-      // Compute the equivalent energy of the interference
-      // Power [mW] = 10^(Power[dBm]/10)
-      // Power [W] = Power [mW] / 1000
-      double interfererPowerW = pow (10, interfererPower / 10) / 1000;
-      // Energy [J] = Time [s] * Power [W]
-      double interferenceEnergy = overlap.GetSeconds () * interfererPowerW;
-      cumulativeInterferenceEnergy.at (unsigned(interfererSf) - 7) += interferenceEnergy;
-      NS_LOG_DEBUG ("Interferer power in W: " << interfererPowerW);
+      // Compute the equivalent energy of the interference from the linear
+      // power computed when the event was created
+      // Energy [mW s] = Time [s] * Power [mW]
+      double interferenceEnergy = overlap.GetSeconds () * interferer->GetRxPowermW ();
+      cumulativeInterferenceEnergy[interfererSf - 6] += interferenceEnergy;
+      NS_LOG_DEBUG ("Interferer power in mW: " << interferer->GetRxPowermW ());
       NS_LOG_DEBUG ("Interference energy: " << interferenceEnergy);
-      it++;
+    }
+
+  double signalEnergy = duration.GetSeconds () * rxPowermW;
+  NS_LOG_DEBUG ("Signal power in mW: " << rxPowermW);
+  NS_LOG_DEBUG ("Signal energy: " << signalEnergy);
+
+  // The packet survives the interference of an SF if
+  //   10 log10 (signalEnergy / interferenceEnergy) >= isolation [dB]
+  // which, in the linear domain, is
+  //   signalEnergy >= interferenceEnergy * 10^(isolation / 10)
+  // Evaluate all seven SFs without branching so the loop can be vectorized.
+  const double *isolation = m_collisionSnir->linear[sf - 6];
+  bool destroyed[7];
+
+  for (int k = 0; k < 7; k++)
+    {
+      destroyed[k] = (cumulativeInterferenceEnergy[k] > 0) &&
+                     (signalEnergy < cumulativeInterferenceEnergy[k] * isolation[k]);
     }
 
   // For each SF, check if there was destructive interference
-  for (uint8_t currentSf = uint8_t (7); currentSf <= uint8_t (12); currentSf++)
+  for (uint8_t currentSf = uint8_t (6); currentSf <= uint8_t (12); currentSf++)
     {
       NS_LOG_DEBUG ("Cumulative Interference Energy: "
-                    << cumulativeInterferenceEnergy.at (unsigned(currentSf) - 7));
-
-      // Use the computed cumulativeInterferenceEnergy to determine whether the
-      // interference with this SF destroys the packet
-      double signalPowerW = pow (10, rxPowerDbm / 10) / 1000;
-      double signalEnergy = duration.GetSeconds () * signalPowerW;
-      NS_LOG_DEBUG ("Signal power in W: " << signalPowerW);
-      NS_LOG_DEBUG ("Signal energy: " << signalEnergy);
-
-      // Check whether the packet survives the interference of this SF
-      double snirIsolation = m_collisionSnir[unsigned(sf) - 7][unsigned(currentSf) - 7];
-      NS_LOG_DEBUG ("The needed isolation to survive is " << snirIsolation << " dB");
-      double snir =
-          10 * log10 (signalEnergy / cumulativeInterferenceEnergy.at (unsigned(currentSf) - 7));
-      NS_LOG_DEBUG ("The current SNIR is " << snir << " dB");
-
-      if (snir >= snirIsolation)
-        {
-          // Move on and check the rest of the interferers
-          NS_LOG_DEBUG ("Packet survived interference with SF " << currentSf);
-        }
-      else
+                    << cumulativeInterferenceEnergy[currentSf - 6]);
+      NS_LOG_DEBUG ("The needed isolation to survive is "
+                    << m_collisionSnir->dB[sf - 6][currentSf - 6] << " dB");
+      NS_LOG_DEBUG ("The current SNIR is "
+                    << 10 * log10 (signalEnergy / cumulativeInterferenceEnergy[currentSf - 6])
+                    << " dB");
+
+      if (destroyed[currentSf - 6])
         {
           NS_LOG_DEBUG ("Packet destroyed by interference with SF" << unsigned(currentSf));
 
           return currentSf;
         }
+
+      // Move on and check the rest of the interferers
+      NS_LOG_DEBUG ("Packet survived interference with SF " << unsigned(currentSf));
     }
   // If we get to here, it means that the packet survived all interference
   NS_LOG_DEBUG ("Packet survived all interference");
@@ -365,7 +568,13 @@ LoraInterferenceHelper::ClearAllEvents (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  m_events.clear ();
+  for (uint32_t i = 0; i < m_nEvents; i++)
+    {
+      EventAt (i) = Ptr<LoraInterferenceHelper::Event> ();
+    }
+
+  m_head = 0;
+  m_nEvents = 0;
 }
 
 Time
@@ -28,6 +28,8 @@
 #include "ns3/callback.h"
 #include "ns3/packet.h"
 #include <list>
+#include <vector>
+#include <limits>
 
 namespace ns3 {
 namespace lora_mesh {
@@ -37,7 +39,8 @@ namespace lora_mesh {
  *
  * This class keeps a list of signals that are impinging on the antenna of the
  * device, in order to compute which ones can be correctly received and which
- * ones are lost due to interference.
+ * ones are lost due to interference. Signals are kept ordered by start time
+ * and expire as soon as they can no longer overlap a reception.
  */
 class LoraInterferenceHelper
 {
@@ -54,6 +57,8 @@ public:
   public:
     Event (Time duration, double rxPowerdBm, uint8_t spreadingFactor, Ptr<Packet> packet,
            double frequencyMHz);
+    Event (Time startTime, Time duration, double rxPowerdBm, uint8_t spreadingFactor,
+           Ptr<Packet> packet, double frequencyMHz);
     ~Event ();
 
     /**
@@ -76,6 +81,11 @@ public:
      */
     double GetRxPowerdBm (void) const;
 
+    /**
+     * Get the power of the event in mW.
+     */
+    double GetRxPowermW (void) const;
+
     /**
      * Get the spreading factor used by this signal.
      */
@@ -96,6 +106,41 @@ public:
      */
     void Print (std::ostream &stream) const;
 
+    /**
+     * Allocate storage for an event from the shared event pool.
+     *
+     * Events are created for every signal reaching every device, so they are
+     * carved out of blocks of EVENT_POOL_BLOCK events and recycled through a
+     * free list. Once the last reference to an event is dropped its storage
+     * goes back to the pool, so the heap is only touched when the number of
+     * live events grows past anything seen before.
+     */
+    static void *operator new (size_t size);
+
+    /**
+     * Return the storage of an event to the shared event pool.
+     */
+    static void operator delete (void *p);
+
+    /**
+     * Enable or disable the event pool. Without the pool each event is
+     * allocated on the heap on its own. Can only be changed while no events
+     * are alive.
+     *
+     * \param enabled Whether events are allocated from the pool.
+     */
+    static void SetPoolEnabled (bool enabled);
+
+    /**
+     * Get the number of events the pool can hold without going to the heap.
+     */
+    static uint32_t GetPoolCapacity (void);
+
+    /**
+     * Get the number of events currently alive.
+     */
+    static uint32_t GetNLiveEvents (void);
+
   private:
     /**
      * The time this signal begins (at the device).
@@ -117,6 +162,11 @@ public:
      */
     double m_rxPowerdBm;
 
+    /**
+     * The power of this event in mW, computed once at construction.
+     */
+    double m_rxPowermW;
+
     /**
      * The packet this event was generated for.
      */
@@ -131,6 +181,17 @@ public:
   enum CollisionMatrix {
     GOURSAUD,
     ALOHA,
+    CUSTOM,
+  };
+
+  /**
+   * A collision (isolation) matrix, indexed by [signal SF - 6][interferer SF - 6],
+   * kept both in dB and in linear form, 10^(isolation/10).
+   */
+  struct CollisionSnir
+  {
+    double dB[7][7];
+    double linear[7][7];
   };
 
   static TypeId GetTypeId (void);
@@ -152,6 +213,23 @@ public:
   Ptr<LoraInterferenceHelper::Event> Add (Time duration, double rxPower, uint8_t spreadingFactor,
                                           Ptr<Packet> packet, double frequencyMHz);
 
+  /**
+   * Add an event which started arriving at the device before now, e.g. a signal
+   * that was already on air when the device tuned to its frequency.
+   *
+   * \param startTime the time the signal started arriving at the device.
+   * \param duration the duration of the packet.
+   * \param rxPower the received power in dBm.
+   * \param spreadingFactor the spreading factor used by the transmission.
+   * \param packet The packet carried by this transmission.
+   * \param frequencyMHz The frequency this event was sent at.
+   *
+   * \return the newly created event
+   */
+  Ptr<LoraInterferenceHelper::Event> Add (Time startTime, Time duration, double rxPower,
+                                          uint8_t spreadingFactor, Ptr<Packet> packet,
+                                          double frequencyMHz);
+
   /**
    * Get a list of the interferers currently registered at this
    * InterferenceHelper.
@@ -194,24 +272,122 @@ public:
    */
   void CleanOldEvents (void);
 
+  /**
+   * Get the number of events currently kept by this LoraInterferenceHelper.
+   */
+  uint32_t GetNEvents (void) const;
+
+  /**
+   * Set the collision matrix used by this helper. The matrix is referenced, not
+   * copied, so it must outlive the helper.
+   *
+   * \param collisionSnir The collision matrix to be used.
+   */
+  void SetCollisionSnir (const CollisionSnir *collisionSnir);
+
+  /**
+   * Get the shared collision matrix matching one of the predefined choices.
+   *
+   * \param collisionMatrix GOURSAUD or ALOHA.
+   * \return The shared, constant collision matrix.
+   */
+  static const CollisionSnir *GetCollisionSnir (enum CollisionMatrix collisionMatrix);
+
   static CollisionMatrix collisionMatrix;
 
-  static std::vector<std::vector<double>> collisionSnirAloha;
-  static std::vector<std::vector<double>> collisionSnirGoursaud;
+  // Isolation used by the ALOHA matrix where a collision always destroys the
+  // packet, and its linear form
+  static constexpr double infSnir = std::numeric_limits<double>::max ();
+  static constexpr double infLinear = std::numeric_limits<double>::infinity ();
+
+  static constexpr CollisionSnir collisionSnirAloha = {
+      {// SF6  SF7  SF8  SF9  SF10 SF11 SF12
+       {infSnir, -infSnir, -infSnir, -infSnir, -infSnir, -infSnir, -infSnir}, // SF6
+       {-infSnir, infSnir, -infSnir, -infSnir, -infSnir, -infSnir, -infSnir}, // SF7
+       {-infSnir, -infSnir, infSnir, -infSnir, -infSnir, -infSnir, -infSnir}, // SF8
+       {-infSnir, -infSnir, -infSnir, infSnir, -infSnir, -infSnir, -infSnir}, // SF9
+       {-infSnir, -infSnir, -infSnir, -infSnir, infSnir, -infSnir, -infSnir}, // SF10
+       {-infSnir, -infSnir, -infSnir, -infSnir, -infSnir, infSnir, -infSnir}, // SF11
+       {-infSnir, -infSnir, -infSnir, -infSnir, -infSnir, -infSnir, infSnir}}, // SF12
+      {{infLinear, 0, 0, 0, 0, 0, 0},
+       {0, infLinear, 0, 0, 0, 0, 0},
+       {0, 0, infLinear, 0, 0, 0, 0},
+       {0, 0, 0, infLinear, 0, 0, 0},
+       {0, 0, 0, 0, infLinear, 0, 0},
+       {0, 0, 0, 0, 0, infLinear, 0},
+       {0, 0, 0, 0, 0, 0, infLinear}}};
+
+  // The SF6 row and column are not part of Goursaud's measurements: they
+  // extend the pattern of the SF7 row (higher SF interferers) and of the
+  // lower SF interferer columns (-3 dB per SF).
+  static constexpr CollisionSnir collisionSnirGoursaud = {
+      {// SF6  SF7  SF8  SF9  SF10 SF11 SF12
+       {6, -16, -18, -19, -19, -20, -20}, // SF6
+       {-21, 6, -16, -18, -19, -19, -20}, // SF7
+       {-24, -24, 6, -20, -22, -22, -22}, // SF8
+       {-27, -27, -27, 6, -23, -25, -25}, // SF9
+       {-30, -30, -30, -30, 6, -26, -28}, // SF10
+       {-33, -33, -33, -33, -33, 6, -29}, // SF11
+       {-36, -36, -36, -36, -36, -36, 6}}, // SF12
+      {{3.9810717055349722, 0.025118864315095794, 0.015848931924611134,
+        0.012589254117941675, 0.012589254117941675, 0.01, 0.01},
+       {0.007943282347242814, 3.9810717055349722, 0.025118864315095794,
+        0.015848931924611134, 0.012589254117941675, 0.012589254117941675, 0.01},
+       {0.003981071705534973, 0.003981071705534973, 3.9810717055349722,
+        0.01, 0.00630957344480193, 0.00630957344480193, 0.00630957344480193},
+       {0.001995262314968879, 0.001995262314968879, 0.001995262314968879,
+        3.9810717055349722, 0.005011872336272725, 0.0031622776601683794, 0.0031622776601683794},
+       {0.001, 0.001, 0.001,
+        0.001, 3.9810717055349722, 0.0025118864315095794, 0.001584893192461114},
+       {0.0005011872336272725, 0.0005011872336272725, 0.0005011872336272725,
+        0.0005011872336272725, 0.0005011872336272725, 3.9810717055349722, 0.0012589254117941675},
+       {0.00025118864315095795, 0.00025118864315095795, 0.00025118864315095795,
+        0.00025118864315095795, 0.00025118864315095795, 0.00025118864315095795, 3.9810717055349722}}};
 
 private:
-  void SetCollisionMatrix (enum CollisionMatrix collisionMatrix);
+  /**
+   * The collision matrix in use, shared with other helpers.
+   */
+  const CollisionSnir *m_collisionSnir;
+
+  /**
+   * Get the i-th oldest event (by start time) kept in the ring buffer.
+   */
+  Ptr<LoraInterferenceHelper::Event> &EventAt (uint32_t i);
+
+  /**
+   * Insert an event in the ring buffer, keeping it ordered by start time.
+   */
+  void InsertEvent (Ptr<LoraInterferenceHelper::Event> event);
+
+  /**
+   * Get the index of the first event in the ring buffer starting at or after
+   * the given time.
+   */
+  uint32_t LowerBound (Time time);
+
+  /**
+   * The events this LoraInterferenceHelper is keeping track of, in a circular
+   * buffer ordered by start time. The capacity is always a power of two.
+   */
+  std::vector<Ptr<LoraInterferenceHelper::Event>> m_events;
 
-  std::vector<std::vector<double>> m_collisionSnir;
+  /**
+   * Index of the oldest event in the circular buffer.
+   */
+  uint32_t m_head;
 
   /**
-   * A list of the events this LoraInterferenceHelper is keeping track of.
+   * Number of events in the circular buffer.
    */
-  std::list<Ptr<LoraInterferenceHelper::Event>> m_events;
+  uint32_t m_nEvents;
 
   /**
-   * The matrix containing information about how packets survive interference.
+   * The longest duration of the events added so far, bounding how far back
+   * an event overlapping a given time can have started.
    */
+  Time m_maxDuration;
+
   /**
    * The threshold after which an event is considered old and removed from the
    * list.
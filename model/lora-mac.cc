@@ -19,9 +19,15 @@
  */
 
 #include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/enum.h"
 
 #include "ns3/lora-mac.h"
 
+#include <limits>
+#include <sstream>
+
 namespace ns3 {
 namespace lora_mesh {
  
@@ -33,6 +39,88 @@ LoRaMAC::GetTypeId(void)
     static TypeId tid = TypeId("ns3::LoRaMAC")
         .SetParent<Object>()
         .SetGroupName("lora_mesh")
+        .AddAttribute("MinDelay",
+                      "Minimum delay (s) between packet timeslots",
+                      UintegerValue(0),
+                      MakeUintegerAccessor(&LoRaMAC::SetMinDelay, &LoRaMAC::GetMinDelay),
+                      MakeUintegerChecker<uint32_t>())
+        .AddAttribute("MaxDelay",
+                      "Maximum delay (s) between packet timeslots",
+                      UintegerValue(60),
+                      MakeUintegerAccessor(&LoRaMAC::SetMaxDelay, &LoRaMAC::GetMaxDelay),
+                      MakeUintegerChecker<uint32_t>())
+        .AddAttribute("RoutingUpdateFrequency",
+                      "Number of packet timeslots per routing update (1 for every timeslot, "
+                      "2 for every other timeslot, etc.)",
+                      UintegerValue(1),
+                      MakeUintegerAccessor(&LoRaMAC::SetRoutingUpdateFrequency, &LoRaMAC::GetRoutingUpdateFrequency),
+                      MakeUintegerChecker<uint32_t>(1))
+        .AddAttribute("CompactHeaders",
+                      "Whether the headers of packets sent are serialized in the compact format "
+                      "(varint node IDs, 8-bit ETX and 16-bit feedback IDs)",
+                      BooleanValue(false),
+                      MakeBooleanAccessor(&LoRaMAC::m_compactHeaders),
+                      MakeBooleanChecker())
+        .AddAttribute("RoutingUpdateMode",
+                      "How the routing table entries advertised in a routing timeslot are chosen: "
+                      "a single random entry, or as many entries as fit in MaxRoutingPayload in "
+                      "turn or most recently changed first",
+                      EnumValue(SINGLE_RANDOM),
+                      MakeEnumAccessor(&LoRaMAC::SetRoutingUpdateMode, &LoRaMAC::GetRoutingUpdateMode),
+                      MakeEnumChecker(SINGLE_RANDOM, "SingleRandom",
+                                      ROUND_ROBIN, "RoundRobin",
+                                      RECENTLY_CHANGED, "RecentlyChanged"))
+        .AddAttribute("MaxRoutingPayload",
+                      "Maximum size (bytes) of the headers of a multi-entry routing update",
+                      UintegerValue(64),
+                      MakeUintegerAccessor(&LoRaMAC::m_maxRoutingPayload),
+                      MakeUintegerChecker<uint32_t>(1))
+        .AddAttribute("FeedbackPadding",
+                      "Size (bytes) of the dummy payload of feedback packets (0 to send only the "
+                      "headers)",
+                      UintegerValue(50),
+                      MakeUintegerAccessor(&LoRaMAC::m_feedbackPadding),
+                      MakeUintegerChecker<uint32_t>())
+        .AddAttribute("RoutingPadding",
+                      "Size (bytes) of the dummy payload of single-entry routing updates (0 to "
+                      "send only the headers)",
+                      UintegerValue(25),
+                      MakeUintegerAccessor(&LoRaMAC::m_routingPadding),
+                      MakeUintegerChecker<uint32_t>())
+        .AddAttribute("AggregateFeedback",
+                      "Whether the feedback for packets received from the same node before the "
+                      "next packet timeslot is sent in one feedback packet",
+                      BooleanValue(false),
+                      MakeBooleanAccessor(&LoRaMAC::m_aggregateFeedback),
+                      MakeBooleanChecker())
+        .AddAttribute("MaxAggregatedFeedback",
+                      "Maximum number of packets acknowledged by one aggregated feedback packet",
+                      UintegerValue(16),
+                      MakeUintegerAccessor(&LoRaMAC::m_maxAggregatedFeedback),
+                      MakeUintegerChecker<uint32_t>(1, MAXIMUM_FEEDBACK_LIST_ENTRIES))
+        .AddAttribute("TrickleEnabled",
+                      "Whether routing updates follow a Trickle timer (RFC 6206) instead of "
+                      "being sent every RoutingUpdateFrequency packet timeslots",
+                      BooleanValue(false),
+                      MakeBooleanAccessor(&LoRaMAC::SetTrickleEnabled, &LoRaMAC::IsTrickleEnabled),
+                      MakeBooleanChecker())
+        .AddAttribute("TrickleMinInterval",
+                      "Minimum Trickle interval (s), used again whenever the routing table changes",
+                      UintegerValue(60),
+                      MakeUintegerAccessor(&LoRaMAC::m_trickleMinInterval),
+                      MakeUintegerChecker<uint32_t>(1))
+        .AddAttribute("TrickleDoublings",
+                      "Number of times the Trickle interval doubles while the routing table is "
+                      "consistent",
+                      UintegerValue(6),
+                      MakeUintegerAccessor(&LoRaMAC::m_trickleDoublings),
+                      MakeUintegerChecker<uint32_t>(0, 16))
+        .AddAttribute("TrickleRedundancy",
+                      "Number of consistent routing updates heard in a Trickle interval which "
+                      "suppress the routing update of the node (0 to never suppress)",
+                      UintegerValue(2),
+                      MakeUintegerAccessor(&LoRaMAC::m_trickleRedundancy),
+                      MakeUintegerChecker<uint32_t>())
         .AddTraceSource("RxPacketSniffer",
                         "Trace Source which simulates sniffer for received data packets",
                         MakeTraceSourceAccessor(&LoRaMAC::m_rxPacketSniffer),
@@ -40,7 +128,12 @@ LoRaMAC::GetTypeId(void)
         .AddTraceSource("TxPacketSniffer",
                         "Trace Source which simulates sniffer for transmitted data packets",
                         MakeTraceSourceAccessor(&LoRaMAC::m_txPacketSniffer),
-                        "ns3::LoRaMAC::TxPacketSnifferTracedCallback");
+                        "ns3::LoRaMAC::TxPacketSnifferTracedCallback")
+        .AddTraceSource("MacEvent",
+                        "Trace Source reporting structured records of routing updates and packets "
+                        "sent and received by the MAC",
+                        MakeTraceSourceAccessor(&LoRaMAC::m_macEvent),
+                        "ns3::LoRaMAC::MacEventTracedCallback");
         
     return tid;
 }
@@ -48,10 +141,28 @@ LoRaMAC::GetTypeId(void)
 LoRaMAC::LoRaMAC()
 {
     m_last_counter = 0;
+    m_started = false;
     m_minDelay = 0;
     m_maxDelay = 60;
     m_routingUpdateFreq = 1;
     m_routingUpdateCounter = 0;
+    m_compactHeaders = false;
+    m_routingUpdateMode = SINGLE_RANDOM;
+    m_maxRoutingPayload = 64;
+    m_feedbackPadding = 50;
+    m_routingPadding = 25;
+    m_aggregateFeedback = false;
+    m_maxAggregatedFeedback = 16;
+    m_trickleEnabled = false;
+    m_trickleMinInterval = 60;
+    m_trickleDoublings = 6;
+    m_trickleRedundancy = 2;
+    m_trickleInterval = Seconds(0);
+    m_trickleCounter = 0;
+    m_trickleAdvertise = false;
+    m_tableVersion = 0;
+    
+    m_rng = CreateObject<UniformRandomVariable>();
 }
 
 LoRaMAC::~LoRaMAC()
@@ -68,11 +179,8 @@ LoRaMAC::SetPHY(Ptr<LoRaPHY> phy)
     {
         m_phy = phy;
         
-        Ptr<UniformRandomVariable> x = CreateObject<UniformRandomVariable>();
-        double temp = x->GetValue(m_minDelay, m_maxDelay);
-        Time dur = Seconds(temp);
-        
-        Simulator::Schedule(dur, &LoRaMAC::PacketTimeslot, this);
+        /*  no draws from the random variable until streams can have been assigned  */
+        Simulator::ScheduleNow(&LoRaMAC::StartTimeslots, this);
     }
     else
     {
@@ -91,7 +199,6 @@ LoRaMAC::GetPHY (void) const
 void
 LoRaMAC::SetDevice (Ptr<LoRaNetDevice> device)
 {
-    Vector3D pos;
     m_device = device;
     
     
@@ -105,8 +212,7 @@ LoRaMAC::SetDevice (Ptr<LoRaNetDevice> device)
     
     if (m_phy && m_phy->GetMobility())
     {
-        pos = m_phy->GetMobility()->GetPosition();
-        NS_LOG_INFO("Node #" << GetId() << "(x=" << pos.x << " y=" << pos.y << " z=" << pos.z << ")" << ": Added entry (" << first_entry.s << "->" << first_entry.r << ")");
+        NS_LOG_INFO("Node #" << GetId() << "(" << GetPositionString() << ")" << ": Added entry (" << first_entry.s << "->" << first_entry.r << ")");
     }
     
     return;
@@ -166,45 +272,103 @@ LoRaMAC::SetRoutingUpdateFrequency(uint32_t freq)
     return;
 }
 
+void
+LoRaMAC::SetRoutingUpdateMode(RoutingUpdateMode mode)
+{
+    m_routingUpdateMode = mode;
+    return;
+}
+
+RoutingUpdateMode
+LoRaMAC::GetRoutingUpdateMode(void) const
+{
+    return m_routingUpdateMode;
+}
+
+void
+LoRaMAC::SetTrickleEnabled(bool enabled)
+{
+    if (enabled == m_trickleEnabled)
+    {
+        return;
+    }
+    
+    m_trickleEnabled = enabled;
+    
+    if (!m_started)
+    {
+        return;     /*  StartTimeslots starts the timer */
+    }
+    
+    if (enabled)
+    {
+        m_trickleInterval = Seconds(m_trickleMinInterval);
+        StartTrickleInterval();
+    }
+    else
+    {
+        Simulator::Cancel(m_trickleTimer);
+        Simulator::Cancel(m_trickleIntervalEnd);
+        
+        m_trickleInterval = Seconds(0);
+        m_trickleAdvertise = false;
+    }
+    
+    return;
+}
+
+bool
+LoRaMAC::IsTrickleEnabled(void) const
+{
+    return m_trickleEnabled;
+}
+
 uint32_t
 LoRaMAC::GetRoutingUpdateFrequency(void) const
 {
     return m_routingUpdateFreq;
 }
 
+int64_t
+LoRaMAC::AssignStreams(int64_t stream)
+{
+    m_rng->SetStream(stream);
+    return 1;
+}
+
+uint64_t
+LoRaMAC::GetTableKey(uint32_t s, uint32_t r)
+{
+    return ((uint64_t)s << 32) | r;
+}
+
 void 
 LoRaMAC::AddTableEntry(RoutingTableEntry entry)
 {
     NS_LOG_FUNCTION (this << entry.s << entry.r);
     
-    std::deque<RoutingTableEntry>::iterator it = m_table.begin();
+    uint64_t key = GetTableKey(entry.s, entry.r);
     
-    if (m_table.empty())
+    if (m_tableIndex.find(key) != m_tableIndex.end())
     {
-        m_table.insert(it, entry);
+        /*  entry already exists -- dont add duplicates */
         return;
     }
     
-    for (;it != m_table.end();++it)
+    m_tableIndex[key] = m_table.size();
+    m_table.push_back(entry);
+    
+    /*  new entries are advertised first when advertising recently changed entries  */
+    if (m_routingUpdateMode == RECENTLY_CHANGED)
     {
-        if (it->s > entry.s)
-        {
-            m_table.insert(it, entry);
-            return;
-        }
-        else if (it->s == entry.s && it->r > entry.r)
-        {
-            m_table.insert(it, entry);
-            return;
-        }
-        else if (it->s == entry.s && it->r == entry.r)
-        {
-            /*  entry already exists -- dont add duplicates */
-            return;
-        }
+        m_advertisePos[key] = m_advertiseOrder.insert(m_advertiseOrder.begin(), key);
+    }
+    else
+    {
+        m_advertisePos[key] = m_advertiseOrder.insert(m_advertiseOrder.end(), key);
     }
     
-    m_table.insert(it, entry);
+    NotifyEntryChanged(entry.s, entry.r, std::numeric_limits<float>::infinity(), entry.etx);
     return;
 }
 
@@ -213,25 +377,36 @@ LoRaMAC::RemoveTableEntry(uint32_t s, uint32_t r)
 {
     NS_LOG_FUNCTION(this << s << r);
     
-    std::deque<RoutingTableEntry>::iterator it = m_table.begin();
+    std::unordered_map<uint64_t, uint32_t>::iterator it = m_tableIndex.find(GetTableKey(s, r));
     
-    if (m_table.empty())
+    if (it == m_tableIndex.end())
     {
-        /*  nothing to remove   */
+        /*  did not find matching entry */
         return;
     }
     
-    for (;it != m_table.end();++it)
+    uint32_t pos = it->second;
+    float etx = m_table[pos].etx;
+    
+    /*  move the last entry into the gap so the table stays dense   */
+    if (pos != m_table.size() - 1)
     {
-        if (it->s == s && it->r == r)
-        {
-            /*  remove entry    */
-            m_table.erase(it);
-            return;
-        }
+        m_table[pos] = m_table.back();
+        m_tableIndex[GetTableKey(m_table[pos].s, m_table[pos].r)] = pos;
+    }
+    
+    m_table.pop_back();
+    m_tableIndex.erase(it);
+    
+    std::unordered_map<uint64_t, std::list<uint64_t>::iterator>::iterator pit = m_advertisePos.find(GetTableKey(s, r));
+    
+    if (pit != m_advertisePos.end())
+    {
+        m_advertiseOrder.erase(pit->second);
+        m_advertisePos.erase(pit);
     }
     
-    /*  did not find matching entry */
+    NotifyEntryChanged(s, r, etx, std::numeric_limits<float>::infinity());
     return;
 }
 
@@ -240,51 +415,43 @@ LoRaMAC::UpdateTableEntry(RoutingTableEntry entry)
 {
     NS_LOG_FUNCTION(this << entry.s << entry.r);
     
-    std::deque<RoutingTableEntry>::iterator it = m_table.begin();
+    std::unordered_map<uint64_t, uint32_t>::iterator it = m_tableIndex.find(GetTableKey(entry.s, entry.r));
     
-    if (m_table.empty())
+    if (it == m_tableIndex.end())
     {
-        /*  update by adding    */
+        /*  could not find -- add in entry  */
         AddTableEntry(entry);
         return;
     }
     
-    for (;it != m_table.end();++it)
+    /*  update  */
+    RoutingTableEntry &cur = m_table[it->second];
+    float etx = cur.etx;
+    
+    cur.etx = entry.etx;
+    cur.last = entry.last;
+    
+    if (m_routingUpdateMode == RECENTLY_CHANGED && etx != entry.etx)
     {
-        if (it->s == entry.s && it->r == entry.r)
-        {
-            /*  update  */
-            it->etx = entry.etx;
-            it->last = entry.last;
-            return;
-        }
+        std::list<uint64_t>::iterator pos = m_advertisePos[it->first];
+        m_advertiseOrder.splice(m_advertiseOrder.begin(), m_advertiseOrder, pos);
     }
     
-    /*  could not find -- add in entry  */
-    AddTableEntry(entry);
+    NotifyEntryChanged(entry.s, entry.r, etx, entry.etx);
     return;
 }
 
 bool
 LoRaMAC::EntryExists(RoutingTableEntry entry)
 {
-    std::deque<RoutingTableEntry>::iterator it = m_table.begin();
-    
-    if (m_table.empty())
-    {
-        return false;
-    }
-    
-    for (;it != m_table.end();++it)
-    {
-        if (it->s == entry.s && it->r == entry.r)
-        {
-            /*  only checks src and dest equality   */
-            return true;
-        }
-    }
-    
-    return false;
+    /*  only checks src and dest equality   */
+    return m_tableIndex.find(GetTableKey(entry.s, entry.r)) != m_tableIndex.end();
+}
+
+uint32_t
+LoRaMAC::GetTableSize(void) const
+{
+    return m_table.size();
 }
 
 bool
@@ -304,14 +471,11 @@ LoRaMAC::TableLookup (uint32_t s, uint32_t r)
     RoutingTableEntry err = {GetId(), GetId(), 1, 0};   /*  an error return since it ought to be 
                                                             0 etx for node to transmit to itself   */
                                                             
-    std::deque<RoutingTableEntry>::iterator it = m_table.begin();
+    std::unordered_map<uint64_t, uint32_t>::iterator it = m_tableIndex.find(GetTableKey(s, r));
     
-    for (;it != m_table.end();++it)
+    if (it != m_tableIndex.end())
     {
-        if (it->s == s && it->r == r)
-        {
-            return (*it);
-        }
+        return m_table[it->second];
     }
  
     return err; /*  returns initialised val */
@@ -323,10 +487,12 @@ LoRaMAC::Receive (Ptr<Packet> packet)
     LoRaMeshHeader header;
     LoRaMeshRoutingHeader rheader;
     LoRaMeshFeedbackHeader fheader;
-    Ptr<Packet> feedback, new_packet;
+    LoRaMeshRoutingListHeader lheader;
+    LoRaMeshFeedbackListHeader flheader;
+    Ptr<Packet> new_packet;
     
-    Vector3D pos = m_phy->GetMobility()->GetPosition();;
-    RoutingTableEntry entry, temp;
+    RoutingTableEntry entry;
+    uint64_t version = m_tableVersion;
     
     packet->PeekHeader(header);
     
@@ -334,6 +500,7 @@ LoRaMAC::Receive (Ptr<Packet> packet)
     {
         case ROUTING_UPDATE:
             packet->RemoveHeader(header);
+            rheader.SetCompact(header.IsCompact());
             packet->RemoveHeader(rheader);
             
             entry.s = header.GetSrc();
@@ -341,66 +508,56 @@ LoRaMAC::Receive (Ptr<Packet> packet)
             entry.etx = rheader.GetETX();
             entry.last = rheader.GetLast();
             
-            NS_LOG_INFO("(receive MAC)Node (x=" << pos.x << " y=" << pos.y << " z=" << pos.z << ")#" << header.GetFwd() << "->#" << GetId() << ": " << entry.s << "->" << entry.r << " (etx: " << entry.etx << ")");
+            NS_LOG_INFO("(receive MAC)Node (" << GetPositionString() << ")#" << header.GetFwd() << "->#" << GetId() << ": " << entry.s << "->" << entry.r << " (etx: " << entry.etx << ")");
+            NotifyMacEvent(MAC_RX_ROUTING_UPDATE, entry.s, entry.r, header.GetFwd(), packet->GetUid(), entry.etx);
             
-            if (EntryExists(entry))
-            {
-                temp = TableLookup(header.GetFwd(), GetId());
-                UpdateTableEntry(entry);
-                
-                if (!IsErrEntry(temp))
-                {
-                    temp.etx = (entry.last > temp.last)?(entry.last - temp.last):(255 - temp.last + entry.last);
-                    temp.last = entry.last;
-                    
-                    if (temp.etx > 10)
-                    {
-                        RemoveTableEntry(temp.s, temp.r);
-                    }
-                    else
-                    {
-                        UpdateTableEntry(temp); /*  update etx and last  */
-                    }
-                }
-                
-            }
-            else
+            ApplyRoutingEntry(entry, header.GetFwd(), true);
+            
+            if (m_tableVersion == version)
             {
-                if (entry.s == entry.r)
-                {
-                    entry.etx = (entry.last + 1);
-                    entry.r = GetId();  /*  node broadcasting itself was received so adds that as the entry     */
-                }
-                
-                if (entry.etx <= 10)
-                {
-                    NS_LOG_INFO("Node #" << GetId() << ": Added entry (" << entry.s << "->" << entry.r << ")");
-                    AddTableEntry(entry);
-                }
+                m_trickleCounter++;     /*  consistent routing update   */
             }
+            
             packet->AddHeader(rheader);
             packet->AddHeader(header);
             
             
+            break;
+        case ROUTING_UPDATES:
+            packet->RemoveHeader(header);
+            lheader.SetCompact(header.IsCompact());
+            packet->RemoveHeader(lheader);
+            
+            NS_LOG_INFO("(receive MAC)Node (" << GetPositionString() << ")#" << header.GetFwd() << "->#" << GetId() << ": " << lheader.GetEntries().size() << " routing entries");
+            
+            ApplyRoutingList(header.GetFwd(), lheader, packet->GetUid());
+            
+            if (m_tableVersion == version)
+            {
+                m_trickleCounter++;     /*  consistent routing update   */
+            }
+            
+            packet->AddHeader(lheader);
+            packet->AddHeader(header);
+            
             break;
         case DIRECTED:
             
-            NS_LOG_INFO("(receive MAC)Node (x=" << pos.x << " y=" << pos.y << " z=" << pos.z << ")#" << header.GetSrc() << "(" << header.GetFwd() << ")->" << GetId() << ": Packet #" << packet->GetUid());
+            NS_LOG_INFO("(receive MAC)Node (" << GetPositionString() << ")#" << header.GetSrc() << "(" << header.GetFwd() << ")->" << GetId() << ": Packet #" << packet->GetUid());
+            NotifyMacEvent(MAC_RX_DIRECTED, header.GetSrc(), header.GetDest(), header.GetFwd(), packet->GetUid(), 0);
             
             m_rxPacketSniffer(packet);
             
             if (header.GetDest() == GetId())
             {
-                feedback = MakeFeedback(packet, header.GetFwd());
-                AddPacketToQueue(feedback, true);
+                QueueFeedback(packet, header.GetFwd());
                 break;
             }
             
             /*  forward if not recipient    */
             if (CalcETX(GetId(), header.GetDest()) < CalcETX(header.GetFwd(), header.GetDest()))
             {
-                feedback = MakeFeedback(packet, header.GetFwd());
-                AddPacketToQueue(feedback, true);
+                QueueFeedback(packet, header.GetFwd());
                 new_packet = packet->Copy();
                 new_packet->RemoveHeader(header);            
                 header.SetFwd(GetId());
@@ -412,17 +569,21 @@ LoRaMAC::Receive (Ptr<Packet> packet)
         case FEEDBACK:
             
             packet->RemoveHeader(header);
+            fheader.SetCompact(header.IsCompact());
             packet->RemoveHeader(fheader);
             
-            NS_LOG_INFO("(receive MAC)Node (x=" << pos.x << " y=" << pos.y << " z=" << pos.z << ")#" << header.GetFwd() << "->" << GetId() << ": Feedback #" << fheader.GetPacketId());
+            NS_LOG_INFO("(receive MAC)Node (" << GetPositionString() << ")#" << header.GetFwd() << "->" << GetId() << ": Feedback #" << fheader.GetPacketId());
+            NotifyMacEvent(MAC_RX_FEEDBACK, header.GetSrc(), header.GetDest(), header.GetFwd(), fheader.GetPacketId(), 0);
             
-            if (header.GetDest() == GetId() && !m_packet_queue.empty())
+            if (header.GetDest() == GetId() && !IsQueueEmpty())
             {
-                if (isPacketInQueue(fheader.GetPacketId())) /*  for feedback for packets    */
+                uint64_t pid;
+                
+                if (ResolveFeedbackId(fheader, pid) && isPacketInQueue(pid)) /*  for feedback for packets    */
                 {
                     packet->AddHeader(fheader);
                     packet->AddHeader(header);
-                    RemovePacketFromQueue(fheader.GetPacketId());
+                    RemovePacketFromQueue(pid);
                     break;
                 }
                 else if (isPacketInQueue(packet->GetUid()))
@@ -448,6 +609,41 @@ LoRaMAC::Receive (Ptr<Packet> packet)
             packet->AddHeader(fheader);
             packet->AddHeader(header);
             break;
+        case FEEDBACKS:
+            
+            packet->RemoveHeader(header);
+            flheader.SetCompact(header.IsCompact());
+            packet->RemoveHeader(flheader);
+            
+            NS_LOG_INFO("(receive MAC)Node (" << GetPositionString() << ")#" << header.GetFwd() << "->" << GetId() << ": Feedback for " << flheader.GetPacketIds().size() << " packets");
+            
+            for (std::vector<uint64_t>::const_iterator it = flheader.GetPacketIds().begin();it != flheader.GetPacketIds().end();++it)
+            {
+                NotifyMacEvent(MAC_RX_FEEDBACK, header.GetSrc(), header.GetDest(), header.GetFwd(), *it, 0);
+                
+                if (header.GetDest() == GetId())
+                {
+                    uint64_t pid;
+                    
+                    if (ResolveFeedbackId(*it, flheader.IsCompact(), pid) && isPacketInQueue(pid))
+                    {
+                        RemovePacketFromQueue(pid);
+                    }
+                }
+            }
+            
+            if (header.GetDest() != GetId() && CalcETX(header.GetFwd(), header.GetDest()) > CalcETX(GetId(), header.GetDest()))
+            {
+                new_packet = packet->Copy();
+                new_packet->AddHeader(flheader);
+                header.SetFwd(GetId());
+                new_packet->AddHeader(header);
+                AddPacketToQueue(new_packet, true);
+            }
+            
+            packet->AddHeader(flheader);
+            packet->AddHeader(header);
+            break;
     }
 }
 
@@ -458,6 +654,16 @@ LoRaMAC::Send(Ptr<Packet> packet)
     
     if (m_phy)
     {
+        if (m_compactHeaders)
+        {
+            /*  the header was added by the sender, re-encode it in the compact format   */
+            LoRaMeshHeader header;
+            
+            packet->RemoveHeader(header);
+            header.SetCompact(true);
+            packet->AddHeader(header);
+        }
+        
         AddPacketToQueue(packet, false);
     }
     
@@ -478,6 +684,7 @@ LoRaMAC::SendTo(Ptr<Packet> packet, uint32_t dest)
         header.SetSrc(GetId());
         header.SetDest(dest);
         header.SetFwd(GetId());
+        header.SetCompact(m_compactHeaders);
         
         packet->AddHeader(header);
         AddPacketToQueue(packet, false);
@@ -491,28 +698,17 @@ LoRaMAC::AddPacketToQueue(Ptr<Packet> packet, bool isFeedback)
 {
     NS_LOG_FUNCTION(this << packet << isFeedback);
     
-    std::deque<Ptr<Packet>>::iterator it;
-    LoRaMeshHeader header;
+    std::list<QueuedPacket> &lane = isFeedback ? m_feedback_queue : m_data_queue;
+    QueuedPacket queued;
     
-    if (isFeedback)
-    {
-        for (it = m_packet_queue.begin();it != m_packet_queue.end();++it)
-        {
-            (*it)->PeekHeader(header);
-            
-            if (header.GetType() != FEEDBACK)
-            {
-                m_packet_queue.insert(it, packet);
-                return;
-            }
-        }
-        
-        m_packet_queue.push_back(packet); /*    only feeedback or empty queue   */
-    }
-    else
-    {
-        m_packet_queue.push_back(packet);
-    }
+    queued.packet = packet;
+    queued.isFeedback = isFeedback;
+    packet->PeekHeader(queued.header);
+    
+    /*  feedback packets go after the other feedback packets but before any other packet    */
+    lane.push_back(queued);
+    m_queue_index[packet->GetUid()].push_back(--lane.end());
+    m_short_index[packet->GetUid() & 0xffff][packet->GetUid()]++;
     
     return;
 }
@@ -522,15 +718,41 @@ LoRaMAC::RemovePacketFromQueue(uint32_t pid)
 {
     NS_LOG_FUNCTION(this << pid);
     
-    std::deque<Ptr<Packet>>::iterator it;
+    std::unordered_map<uint64_t, std::deque<std::list<QueuedPacket>::iterator>>::iterator it = m_queue_index.find(pid);
+    
+    if (it == m_queue_index.end())
+    {
+        return;
+    }
+    
+    /*  remove the first packet queued with the packet ID   */
+    std::list<QueuedPacket>::iterator queued = it->second.front();
+    
+    if (queued->isFeedback)
+    {
+        m_feedback_queue.erase(queued);
+    }
+    else
+    {
+        m_data_queue.erase(queued);
+    }
+    
+    it->second.pop_front();
+    
+    if (it->second.empty())
+    {
+        m_queue_index.erase(it);
+    }
+    
+    std::unordered_map<uint16_t, std::unordered_map<uint64_t, uint32_t>>::iterator sit = m_short_index.find(pid & 0xffff);
     
-    for (it = m_packet_queue.begin();it != m_packet_queue.end();++it)
+    if (--sit->second[pid] == 0)
     {
-        if ((*it)->GetUid() == pid)
+        sit->second.erase(pid);
+        
+        if (sit->second.empty())
         {
-            /*  remove packet if found  */
-            m_packet_queue.erase(it);
-            return;
+            m_short_index.erase(sit);
         }
     }
 
@@ -542,23 +764,102 @@ LoRaMAC::isPacketInQueue(uint32_t pid)
 {
     NS_LOG_FUNCTION(this << pid);
     
-    std::deque<Ptr<Packet>>::iterator it;
+    return m_queue_index.find(pid) != m_queue_index.end();
+}
+
+bool
+LoRaMAC::ResolveFeedbackId(const LoRaMeshFeedbackHeader &fheader, uint64_t &pid) const
+{
+    return ResolveFeedbackId(fheader.GetPacketId(), fheader.IsCompact(), pid);
+}
+
+bool
+LoRaMAC::ResolveFeedbackId(uint64_t packet_id, bool compact, uint64_t &pid) const
+{
+    if (!compact)
+    {
+        pid = packet_id;
+        return true;
+    }
+    
+    std::unordered_map<uint16_t, std::unordered_map<uint64_t, uint32_t>>::const_iterator it = m_short_index.find(packet_id & 0xffff);
     
-    for (it = m_packet_queue.begin();it != m_packet_queue.end();++it)
+    if (it == m_short_index.end())
     {
-        if ((*it)->GetUid() == pid)
-        {
-            return true;
-        }
+        return false;
     }
     
-    return false;
+    if (it->second.size() > 1)
+    {
+        /*  packet IDs are handed out in sequence, so this needs a queue spanning 65536 packet IDs  */
+        NS_LOG_WARN("Node #" << GetId() << ": " << it->second.size() << " queued packets share the short packet ID " << packet_id << ", feedback ignored");
+        return false;
+    }
+    
+    pid = it->second.begin()->first;
+    return true;
+}
+
+bool
+LoRaMAC::IsQueueEmpty(void) const
+{
+    return m_feedback_queue.empty() && m_data_queue.empty();
 }
 
 Ptr<Packet> 
 LoRaMAC::GetNextPacketFromQueue(void)
 {
-    return m_packet_queue.front();
+    if (!m_feedback_queue.empty())
+    {
+        return m_feedback_queue.front().packet;
+    }
+    
+    return m_data_queue.front().packet;
+}
+
+const LoRaMeshHeader &
+LoRaMAC::GetNextHeaderFromQueue(void) const
+{
+    if (!m_feedback_queue.empty())
+    {
+        return m_feedback_queue.front().header;
+    }
+    
+    return m_data_queue.front().header;
+}
+
+std::string
+LoRaMAC::GetPositionString(void) const
+{
+    std::ostringstream oss;
+    Vector3D pos;
+    
+    if (m_phy && m_phy->GetMobility())
+    {
+        pos = m_phy->GetMobility()->GetPosition();
+    }
+    
+    oss << "x=" << pos.x << " y=" << pos.y << " z=" << pos.z;
+    
+    return oss.str();
+}
+
+void
+LoRaMAC::NotifyMacEvent(LoRaMacEventType type, uint32_t src, uint32_t dest, uint32_t fwd, uint64_t uid, float etx)
+{
+    LoRaMacEvent event;
+    
+    event.type = type;
+    event.node = GetId();
+    event.src = src;
+    event.dest = dest;
+    event.fwd = fwd;
+    event.uid = uid;
+    event.etx = etx;
+    
+    m_macEvent(event);
+    
+    return;
 }
 
 void 
@@ -577,81 +878,454 @@ LoRaMAC::AddToLastPacketList(Ptr<Packet> packet)
 float
 LoRaMAC::CalcETX(uint32_t src, uint32_t dest)
 {
-    std::vector<RoutingTableEntry> checked_nodes;
-    std::deque<RoutingTableEntry>::iterator it, temp;
-    float min;
-    unsigned int i, j;
-    bool flag;
-    RoutingTableEntry entry;
-    entry.r = src;
-    entry.etx = 0;
+    if (src == dest)
+    {
+        return 0;
+    }
+    
+    std::unordered_map<uint32_t, ShortestPathTree>::iterator tree = m_paths.find(src);
+    
+    if (tree == m_paths.end())
+    {
+        /*  build the tree rooted at the source */
+        ETXHeap heap;
+        
+        tree = m_paths.insert(std::make_pair(src, ShortestPathTree())).first;
+        tree->second.etx[src] = 0;
+        heap.push(std::make_pair(0.0f, src));
+        
+        ExpandShortestPathTree(tree->second, heap);
+    }
+    
+    std::unordered_map<uint32_t, float>::iterator it = tree->second.etx.find(dest);
+    
+    if (it == tree->second.etx.end())
+    {
+        return 0;   /*  no known path   */
+    }
     
-    checked_nodes.push_back(entry);
+    return it->second;
+}
+
+void
+LoRaMAC::ExpandShortestPathTree(ShortestPathTree &tree, ETXHeap &heap)
+{
+    std::unordered_map<uint32_t, std::map<uint32_t, float>>::iterator links;
+    std::map<uint32_t, float>::iterator it;
+    std::unordered_map<uint32_t, float>::iterator cur;
+    float etx;
+    uint32_t node;
     
-    for (;;)
+    while (!heap.empty())
     {
-        for (i = 0, min = 1000000;i < checked_nodes.size();i++)
+        etx = heap.top().first;
+        node = heap.top().second;
+        heap.pop();
+        
+        /*  skip stale heap entries */
+        if (etx > tree.etx[node])
         {
-            for (it = m_table.begin();it != m_table.end();++it)
+            continue;
+        }
+        
+        links = m_links.find(node);
+        
+        if (links == m_links.end())
+        {
+            continue;
+        }
+        
+        for (it = links->second.begin();it != links->second.end();++it)
+        {
+            cur = tree.etx.find(it->first);
+            
+            if (cur == tree.etx.end() || etx + it->second < cur->second)
             {
-                if (checked_nodes[i].r == it->s)
-                {
-                    for (j = 0, flag = false;j < checked_nodes.size();j++)
-                    {
-                        if (checked_nodes[j].r == it->r)
-                        {
-                            flag = true;
-                            break;
-                        }
-                    }
-                    
-                    if (!flag && (checked_nodes[i].etx + it->etx) < min)
-                    {
-                        min = checked_nodes[i].etx + it->etx;
-                        temp = it;
-                    }
-                }
+                tree.etx[it->first] = etx + it->second;
+                tree.parent[it->first] = node;
+                heap.push(std::make_pair(etx + it->second, it->first));
             }
         }
-        
-        if (min != 1000000)
+    }
+    
+    return;
+}
+
+void
+LoRaMAC::NotifyEntryChanged(uint32_t s, uint32_t r, float old_etx, float new_etx)
+{
+    if (old_etx != new_etx)
+    {
+        m_tableVersion++;
+        ResetTrickleTimer();
+    }
+    
+    if (s == r)
+    {
+        return;     /*  entries for a node itself are not links */
+    }
+    
+    if (new_etx == std::numeric_limits<float>::infinity())
+    {
+        m_links[s].erase(r);
+    }
+    else
+    {
+        m_links[s][r] = new_etx;
+    }
+    
+    std::unordered_map<uint32_t, ShortestPathTree>::iterator tree = m_paths.begin();
+    std::unordered_map<uint32_t, float>::iterator sender, receiver;
+    std::unordered_map<uint32_t, uint32_t>::iterator parent;
+    
+    while (tree != m_paths.end())
+    {
+        if (new_etx < old_etx)
         {
-            if (temp->r == dest)
+            /*  a cheaper link can only shorten paths through its receiver  */
+            sender = tree->second.etx.find(s);
+            receiver = tree->second.etx.find(r);
+            
+            if (r != tree->first && sender != tree->second.etx.end() && (receiver == tree->second.etx.end() || sender->second + new_etx < receiver->second))
             {
-                return min;
+                ETXHeap heap;
+                
+                tree->second.etx[r] = sender->second + new_etx;
+                tree->second.parent[r] = s;
+                heap.push(std::make_pair(sender->second + new_etx, r));
+                
+                ExpandShortestPathTree(tree->second, heap);
             }
+        }
+        else if (new_etx > old_etx)
+        {
+            /*  a dearer link only matters if the tree uses it  */
+            parent = tree->second.parent.find(r);
             
-            entry.r = temp->r;
-            entry.etx = min;
-            checked_nodes.push_back(entry);
+            if (parent != tree->second.parent.end() && parent->second == s)
+            {
+                tree = m_paths.erase(tree);
+                continue;
+            }
         }
-        else
+        
+        ++tree;
+    }
+    
+    return;
+}
+
+void
+LoRaMAC::ApplyRoutingEntry(RoutingTableEntry entry, uint32_t fwd, bool estimateLink)
+{
+    RoutingTableEntry link;
+    
+    if (EntryExists(entry))
+    {
+        link = TableLookup(fwd, GetId());
+        UpdateTableEntry(entry);
+        
+        if (estimateLink && !IsErrEntry(link))
+        {
+            UpdateLinkEstimate(link, entry.last);
+        }
+    }
+    else
+    {
+        if (entry.s == entry.r)
+        {
+            entry.etx = (entry.last + 1);
+            entry.r = GetId();  /*  node broadcasting itself was received so adds that as the entry     */
+        }
+        
+        if (entry.etx <= 10)
+        {
+            NS_LOG_INFO("Node #" << GetId() << ": Added entry (" << entry.s << "->" << entry.r << ")");
+            AddTableEntry(entry);
+        }
+    }
+    
+    return;
+}
+
+void
+LoRaMAC::UpdateLinkEstimate(RoutingTableEntry link, uint8_t last)
+{
+    link.etx = (last > link.last)?(last - link.last):(255 - link.last + last);
+    link.last = last;
+    
+    if (link.etx > 10)
+    {
+        RemoveTableEntry(link.s, link.r);
+    }
+    else
+    {
+        UpdateTableEntry(link); /*  update etx and last  */
+    }
+    
+    return;
+}
+
+void
+LoRaMAC::ApplyRoutingList(uint32_t fwd, const LoRaMeshRoutingListHeader &lheader, uint64_t uid)
+{
+    RoutingTableEntry entry;
+    
+    /*  the link is estimated once per advertisement, from its state before any of the entries were 
+        applied, as if the entries had been sent one by one with the same counter   */
+    RoutingTableEntry link = TableLookup(fwd, GetId());
+    bool estimate = false;
+    
+    const std::vector<RoutingListEntry> &entries = lheader.GetEntries();
+    std::vector<RoutingListEntry>::const_iterator it = entries.begin();
+    
+    for (;it != entries.end();++it)
+    {
+        entry.s = it->s;
+        entry.r = it->r;
+        entry.etx = it->etx;
+        entry.last = lheader.GetLast();
+        
+        NotifyMacEvent(MAC_RX_ROUTING_UPDATE, entry.s, entry.r, fwd, uid, entry.etx);
+        
+        /*  the forwarder advertising itself, or any entry already known, refreshes the link    */
+        if ((entry.s == fwd && entry.r == fwd) || EntryExists(entry))
+        {
+            estimate = true;
+        }
+        
+        ApplyRoutingEntry(entry, fwd, false);
+    }
+    
+    if (estimate && !IsErrEntry(link))
+    {
+        UpdateLinkEstimate(link, lheader.GetLast());
+    }
+    
+    return;
+}
+
+void
+LoRaMAC::SendRoutingList(void)
+{
+    Ptr<Packet> packet = Create<Packet>(0);
+    LoRaMeshHeader header;
+    LoRaMeshRoutingListHeader lheader;
+    RoutingListEntry lentry;
+    RoutingTableEntry cur;
+    uint32_t size;
+    
+    header.SetType(ROUTING_UPDATES);
+    header.SetSrc(GetId());
+    header.SetDest(GetId());
+    header.SetFwd(GetId());
+    header.SetCompact(m_compactHeaders);
+    
+    lheader.SetLast(m_last_counter);
+    lheader.SetCompact(m_compactHeaders);
+    
+    /*  the entry of this node itself lets the neighbours estimate their link to it even when 
+        the rest of the table is new to them or does not fit   */
+    uint64_t self = GetTableKey(GetId(), GetId());
+    cur = TableLookup(GetId(), GetId());
+    lentry.s = cur.s;
+    lentry.r = cur.r;
+    lentry.etx = cur.etx;
+    lheader.AddEntry(lentry);
+    
+    size = header.GetSerializedSize() + lheader.GetSerializedSize();
+    
+    /*  take entries in advertisement order while they fit, then move them to the back so the 
+        rest of the table goes next */
+    std::list<uint64_t> sent;
+    std::list<uint64_t>::iterator it = m_advertiseOrder.begin();
+    
+    while (it != m_advertiseOrder.end())
+    {
+        if (*it == self)
         {
-            return 0;
+            ++it;
+            continue;
         }
         
+        cur = m_table[m_tableIndex[*it]];
+        lentry.s = cur.s;
+        lentry.r = cur.r;
+        lentry.etx = cur.etx;
+        
+        if (size + LoRaMeshRoutingListHeader::GetEntrySize(lentry, m_compactHeaders) > m_maxRoutingPayload || !lheader.AddEntry(lentry))
+        {
+            break;
+        }
+        
+        size += LoRaMeshRoutingListHeader::GetEntrySize(lentry, m_compactHeaders);
+        sent.splice(sent.end(), m_advertiseOrder, it++);
+    }
+    
+    m_advertiseOrder.splice(m_advertiseOrder.end(), sent);
+    
+    NS_LOG_INFO("(send MAC)Node #" << GetId() << "(" << GetPositionString() << "): " << lheader.GetEntries().size() << " routing entries");
+    
+    const std::vector<RoutingListEntry> &entries = lheader.GetEntries();
+    std::vector<RoutingListEntry>::const_iterator eit = entries.begin();
+    
+    for (;eit != entries.end();++eit)
+    {
+        NotifyMacEvent(MAC_TX_ROUTING_UPDATE, eit->s, eit->r, GetId(), packet->GetUid(), eit->etx);
+    }
+    
+    packet->AddHeader(lheader);
+    packet->AddHeader(header);
+    
+    m_phy->Send(packet);
+    
+    return;
+}
+
+void
+LoRaMAC::StartTrickleInterval(void)
+{
+    NS_LOG_FUNCTION(this << m_trickleInterval.GetSeconds());
+    
+    double t = m_rng->GetValue(m_trickleInterval.GetSeconds() / 2, m_trickleInterval.GetSeconds());
+    
+    m_trickleCounter = 0;
+    m_trickleTimer = Simulator::Schedule(Seconds(t), &LoRaMAC::TrickleTimerExpired, this);
+    m_trickleIntervalEnd = Simulator::Schedule(m_trickleInterval, &LoRaMAC::TrickleIntervalExpired, this);
+    
+    return;
+}
+
+void
+LoRaMAC::TrickleTimerExpired(void)
+{
+    if (m_trickleRedundancy == 0 || m_trickleCounter < m_trickleRedundancy)
+    {
+        /*  advertise in the next routing timeslot, which may fall in a later interval  */
+        m_trickleAdvertise = true;
+    }
+    else
+    {
+        NS_LOG_INFO("Node #" << GetId() << ": Routing update suppressed (" << m_trickleCounter << " consistent updates heard)");
+    }
+    
+    return;
+}
+
+void
+LoRaMAC::TrickleIntervalExpired(void)
+{
+    Time max = Seconds((double)m_trickleMinInterval * (1u << m_trickleDoublings));
+    
+    m_trickleInterval = m_trickleInterval + m_trickleInterval;
+    
+    if (m_trickleInterval > max)
+    {
+        m_trickleInterval = max;
+    }
+    
+    StartTrickleInterval();
+    return;
+}
+
+void
+LoRaMAC::ResetTrickleTimer(void)
+{
+    /*  not running yet, or already at the minimum interval */
+    if (!m_trickleEnabled || m_trickleInterval.IsZero() || m_trickleInterval == Seconds(m_trickleMinInterval))
+    {
+        return;
     }
+    
+    NS_LOG_INFO("Node #" << GetId() << ": Trickle timer reset");
+    
+    Simulator::Cancel(m_trickleTimer);
+    Simulator::Cancel(m_trickleIntervalEnd);
+    
+    m_trickleInterval = Seconds(m_trickleMinInterval);
+    StartTrickleInterval();
+    
+    return;
 }
 
 Ptr<Packet>
 LoRaMAC::MakeFeedback(Ptr<Packet> packet, uint32_t fwd)
 {
-    Ptr<Packet> feedback = Create<Packet>(50);
+    Ptr<Packet> feedback = Create<Packet>(m_feedbackPadding);
     LoRaMeshFeedbackHeader fheader;
     LoRaMeshHeader header;
     
     fheader.SetPacketId(packet->GetUid());
+    fheader.SetCompact(m_compactHeaders);
     feedback->AddHeader(fheader);
     
     header.SetSrc(GetId());
     header.SetDest(fwd);
     header.SetFwd(GetId());
     header.SetType(FEEDBACK);
+    header.SetCompact(m_compactHeaders);
     feedback->AddHeader(header);
     
     return feedback;
 }
 
+void
+LoRaMAC::QueueFeedback(Ptr<Packet> packet, uint32_t fwd)
+{
+    NS_LOG_FUNCTION(this << packet << fwd);
+    
+    if (!m_aggregateFeedback)
+    {
+        AddPacketToQueue(MakeFeedback(packet, fwd), true);
+        return;
+    }
+    
+    LoRaMeshHeader header;
+    LoRaMeshFeedbackListHeader flheader;
+    std::unordered_map<uint32_t, uint64_t>::iterator it = m_feedbackFrames.find(fwd);
+    
+    /*  add to the feedback packet for the node if it has not been sent yet and is not full */
+    if (it != m_feedbackFrames.end() && isPacketInQueue(it->second))
+    {
+        Ptr<Packet> feedback = m_queue_index[it->second].front()->packet;
+        
+        feedback->RemoveHeader(header);
+        flheader.SetCompact(header.IsCompact());
+        feedback->RemoveHeader(flheader);
+        
+        if (flheader.GetPacketIds().size() < m_maxAggregatedFeedback)
+        {
+            flheader.AddPacketId(packet->GetUid());
+            feedback->AddHeader(flheader);
+            feedback->AddHeader(header);
+            return;
+        }
+        
+        feedback->AddHeader(flheader);
+        feedback->AddHeader(header);
+        
+        flheader = LoRaMeshFeedbackListHeader();
+    }
+    
+    Ptr<Packet> feedback = Create<Packet>(0);
+    
+    flheader.AddPacketId(packet->GetUid());
+    flheader.SetCompact(m_compactHeaders);
+    feedback->AddHeader(flheader);
+    
+    header.SetSrc(GetId());
+    header.SetDest(fwd);
+    header.SetFwd(GetId());
+    header.SetType(FEEDBACKS);
+    header.SetCompact(m_compactHeaders);
+    feedback->AddHeader(header);
+    
+    AddPacketToQueue(feedback, true);
+    m_feedbackFrames[fwd] = feedback->GetUid();
+    
+    return;
+}
+
 void
 LoRaMAC::PacketTimeslot(void)
 {
@@ -663,14 +1337,13 @@ LoRaMAC::PacketTimeslot(void)
     unsigned int count;
     double temp;
     Time dur;
-    Vector3D pos = m_phy->GetMobility()->GetPosition();
     
-    if (!m_packet_queue.empty())
+    if (!IsQueueEmpty())
     {
         next = GetNextPacketFromQueue();
-        next->PeekHeader(header);
+        header = GetNextHeaderFromQueue();
         
-        if (CalcETX(GetId(), header.GetDest()) != 0 || header.GetType() == FEEDBACK)
+        if (CalcETX(GetId(), header.GetDest()) != 0 || header.GetType() == FEEDBACK || header.GetType() == FEEDBACKS)
         {
             for (i = MAX_NUMEL_LAST_PACKETS_LIST - 1, count = 0;i >= 0;i--)
             {
@@ -680,17 +1353,18 @@ LoRaMAC::PacketTimeslot(void)
                 }
             }
             
-            NS_LOG_INFO("(send MAC)Node #" << GetId() << " (x=" << pos.x << " y=" << pos.y << " z=" << pos.z << "): " << header.GetSrc() << "->" << header.GetDest() << " Packet #" << next->GetUid());
+            NS_LOG_INFO("(send MAC)Node #" << GetId() << " (" << GetPositionString() << "): " << header.GetSrc() << "->" << header.GetDest() << " Packet #" << next->GetUid());
+            NotifyMacEvent(MAC_TX_PACKET, header.GetSrc(), header.GetDest(), header.GetFwd(), next->GetUid(), 0);
             
             m_phy->Send(next);
             AddToLastPacketList (next);
             
-            if (header.GetType() != FEEDBACK)
+            if (header.GetType() != FEEDBACK && header.GetType() != FEEDBACKS)
             {
                 m_txPacketSniffer(next);
             }
             
-            if (count == 9 || header.GetType() == FEEDBACK)
+            if (count == 9 || header.GetType() == FEEDBACK || header.GetType() == FEEDBACKS)
             {
                 /*  remove if it is on tenth send   */
                 RemovePacketFromQueue(next->GetUid());
@@ -712,8 +1386,7 @@ LoRaMAC::PacketTimeslot(void)
         RoutingTimeslot();
     }
     
-    Ptr<UniformRandomVariable> x = CreateObject<UniformRandomVariable>();
-    temp = x->GetValue(m_minDelay, m_maxDelay);
+    temp = m_rng->GetValue(m_minDelay, m_maxDelay);
     dur = Seconds(temp);
     
     /*  schedule next slot  */
@@ -722,26 +1395,74 @@ LoRaMAC::PacketTimeslot(void)
     return;
 }
 
+void
+LoRaMAC::StartTimeslots(void)
+{
+    NS_LOG_FUNCTION(this);
+    
+    m_started = true;
+    
+    double temp = m_rng->GetValue(m_minDelay, m_maxDelay);
+    Time dur = Seconds(temp);
+    
+    Simulator::Schedule(dur, &LoRaMAC::PacketTimeslot, this);
+    
+    if (m_trickleEnabled)
+    {
+        m_trickleInterval = Seconds(m_trickleMinInterval);
+        StartTrickleInterval();
+    }
+    
+    return;
+}
+
 void
 LoRaMAC::RoutingTimeslot(void)
 {
     NS_LOG_FUNCTION(this);
     
-    m_routingUpdateCounter++;
+    if (m_trickleEnabled)
+    {
+        /*  the Trickle timer decides instead of the routing update frequency   */
+        if (!m_trickleAdvertise)
+        {
+            return;
+        }
+        
+        m_trickleAdvertise = false;
+        
+        /*  consistent updates may have been heard since the timer expired, also in a later interval  */
+        if (m_trickleRedundancy != 0 && m_trickleCounter >= m_trickleRedundancy)
+        {
+            NS_LOG_INFO("Node #" << GetId() << ": Routing update suppressed (" << m_trickleCounter << " consistent updates heard)");
+            return;
+        }
+    }
+    else
+    {
+        m_routingUpdateCounter++;
+        
+        if (m_routingUpdateCounter < m_routingUpdateFreq)
+        {
+            return;
+        }
+    }
     
-    if (m_routingUpdateCounter < m_routingUpdateFreq)
+    if (m_routingUpdateMode != SINGLE_RANDOM)
     {
+        SendRoutingList();
+        
+        /*  increment last counter  */
+        m_last_counter = (m_last_counter == 255)?0:(m_last_counter + 1);
         return;
     }
     
     Time dur;
-    Ptr<Packet> packet = Create<Packet>(25);
+    Ptr<Packet> packet = Create<Packet>(m_routingPadding);
     LoRaMeshHeader header;
-    Vector3D pos = m_phy->GetMobility()->GetPosition();
     
     auto size = m_table.size();
-    Ptr<UniformRandomVariable> x = CreateObject<UniformRandomVariable>();
-    uint32_t temp = x->GetInteger(0, size);
+    uint32_t temp = m_rng->GetInteger(0, size - 1);     /*  bounds are inclusive    */
     
     RoutingTableEntry cur = m_table[temp];
     
@@ -749,12 +1470,15 @@ LoRaMAC::RoutingTimeslot(void)
     header.SetSrc(cur.s);
     header.SetDest(cur.r);
     header.SetFwd(GetId());
+    header.SetCompact(m_compactHeaders);
     
     LoRaMeshRoutingHeader rheader;
     rheader.SetETX(cur.etx);
     rheader.SetLast(m_last_counter);
+    rheader.SetCompact(m_compactHeaders);
     
-    NS_LOG_INFO("(send MAC)Node #" << GetId() << "(x=" << pos.x << " y=" << pos.y << " z=" << pos.z << "): " << cur.s << "->" << cur.r << " (etx: " << cur.etx << ")");
+    NS_LOG_INFO("(send MAC)Node #" << GetId() << "(" << GetPositionString() << "): " << cur.s << "->" << cur.r << " (etx: " << cur.etx << ")");
+    NotifyMacEvent(MAC_TX_ROUTING_UPDATE, cur.s, cur.r, GetId(), packet->GetUid(), cur.etx);
     
     packet->AddHeader(rheader);
     
@@ -37,10 +37,17 @@
 #include "ns3/lora-mesh-header.h"
 #include "ns3/lora-mesh-routing-header.h"
 #include "ns3/lora-mesh-feedback-header.h"
+#include "ns3/lora-mesh-feedback-list-header.h"
+#include "ns3/lora-mesh-routing-list-header.h"
 
 #include <iterator>
+#include <string>
 #include <queue>
 #include <deque>
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <vector>
 
 #define MAX_NUMEL_LAST_PACKETS_LIST 25
 
@@ -64,6 +71,43 @@ struct RoutingTableEntry
     uint8_t     last;    
 };
 
+/*
+ *  How a LoRaMAC chooses the routing table entries it advertises in a routing timeslot
+ */
+enum RoutingUpdateMode
+{
+    SINGLE_RANDOM,      /*  one random entry per routing update (ROUTING_UPDATE)    */
+    ROUND_ROBIN,        /*  as many entries as fit, in turn (ROUTING_UPDATES)   */
+    RECENTLY_CHANGED    /*  as many entries as fit, most recently changed first (ROUTING_UPDATES)   */
+};
+
+/*
+ *  Kinds of LoRaMAC events reported through the MacEvent trace source
+ */
+enum LoRaMacEventType
+{
+    MAC_RX_ROUTING_UPDATE,
+    MAC_RX_DIRECTED,
+    MAC_RX_FEEDBACK,
+    MAC_TX_PACKET,
+    MAC_TX_ROUTING_UPDATE
+};
+
+/*
+ *  Structured record of a LoRaMAC event. Positions are left out so that nothing is looked up
+ *  unless a sink asks the node's MobilityModel for it.
+ */
+struct LoRaMacEvent
+{
+    LoRaMacEventType    type;
+    uint32_t            node;   /*  Node ID of the LoRaMAC  */
+    uint32_t            src;    /*  mesh header fields, or the entry for routing updates    */
+    uint32_t            dest;
+    uint32_t            fwd;
+    uint64_t            uid;    /*  packet ID, or the acknowledged packet ID for feedback   */
+    float               etx;    /*  routing updates only    */
+};
+
 /**
  *  \brief  This class controls the custom mesh protocl MAC layer of the LoRa device.
  * 
@@ -85,7 +129,9 @@ public:
     static TypeId GetTypeId(void);
     
     /**
-     *  Sets the LoRaPHY attached to this LoRaMAC
+     *  Sets the LoRaPHY attached to this LoRaMAC. The first LoRaPHY attached schedules the start
+     *  of the timeslots, whose first delay is drawn when the simulation starts so that streams
+     *  assigned after installation cover it.
      * 
      *  \param  phy pionter to the LoRaPHY to be attached
      */
@@ -165,12 +211,14 @@ public:
     
     /**
      *  Calculates the ETX for sending a packet from a source node to a destination node based
-     *  on the information in this LoRaMAC's routing table.
+     *  on the information in this LoRaMAC's routing table. The shortest path tree rooted at the
+     *  source is cached and kept up to date as the routing table changes, so repeated queries
+     *  between routing table changes are constant time.
      * 
      *  \param  src     source Node ID
      *  \param  dest    destination Node ID
      * 
-     *  \return the computed ETX for shortest known path
+     *  \return the computed ETX for shortest known path, 0 if no path is known
      */
     float CalcETX(uint32_t src, uint32_t dest);
   
@@ -185,6 +233,13 @@ public:
      */
     RoutingTableEntry TableLookup(uint32_t s, uint32_t r);
     
+    /**
+     *  Gets the number of entries in this LoRaMAC's routing table
+     * 
+     *  \return the number of entries in the routing table
+     */
+    uint32_t GetTableSize(void) const;
+    
     /**
      *  Handles the reception of packets, based on the type of packet and if this LoRaMAC is supposed
      *  to be the recipient, and forwards and makes feedback to the packet if necessary.
@@ -218,17 +273,59 @@ public:
      */
     Ptr<Packet> MakeFeedback(Ptr<Packet> packet, uint32_t fwd);
     
+    /**
+     *  Queues the feedback for a given packet. With aggregated feedback it is added to the 
+     *  feedback packet already queued for the forwarding node, if any, so the feedback for all the
+     *  packets received from a node before the next packet timeslot is sent in one packet.
+     * 
+     *  \param  packet  pointer to the packet to queue the feedback for
+     *  \param  fwd     the forwarding node of the packet the feedback is being queued for
+     */
+    void QueueFeedback(Ptr<Packet> packet, uint32_t fwd);
+    
     /**
      *  Sends the next packet in the packet queue (to LoRaPHY), if not empty, and schedules the 
      *  next routing timeslot and the next instance of this function after a randomised delay.
      */
     void PacketTimeslot(void);
     
+    /**
+     *  Schedules the first packet timeslot after a randomised delay (and starts the Trickle timer
+     *  if enabled). Scheduled by SetPHY to run when the simulation starts.
+     */
+    void StartTimeslots(void);
+    
     /**
      *  Creates a new routing update packet and sends it (to LoRaPHY).
      */
     void RoutingTimeslot(void);
     
+    /**
+     *  Sets how the routing table entries advertised in routing timeslots are chosen
+     * 
+     *  \param  mode    SINGLE_RANDOM, ROUND_ROBIN or RECENTLY_CHANGED
+     */
+    void SetRoutingUpdateMode(RoutingUpdateMode mode);
+    
+    /**
+     *  \return how the routing table entries advertised in routing timeslots are chosen
+     */
+    RoutingUpdateMode GetRoutingUpdateMode(void) const;
+    
+    /**
+     *  Sets whether routing updates follow a Trickle timer. Enabling it once the timeslots have 
+     *  started starts a Trickle interval at the minimum interval, disabling it stops the timer.
+     * 
+     *  \param  enabled true to send routing updates following a Trickle timer, false to send them
+     *                  every RoutingUpdateFrequency packet timeslots
+     */
+    void SetTrickleEnabled(bool enabled);
+    
+    /**
+     *  \return true if routing updates follow a Trickle timer, false otherwise
+     */
+    bool IsTrickleEnabled(void) const;
+    
     /**
      *  Sets the minimum delay for the randomisation of the delay between packet timeslots
      * 
@@ -274,6 +371,23 @@ public:
      */
     uint32_t GetRoutingUpdateFrequency(void) const;
     
+    /**
+     *  Assigns a fixed random variable stream number to the random variable used by this
+     *  LoRaMAC for the delay between timeslots and the choice of routing updates
+     * 
+     *  \param  stream  first stream index to use
+     * 
+     *  \return the number of stream indices assigned by this LoRaMAC
+     */
+    int64_t AssignStreams(int64_t stream);
+    
+    /**
+     *  TracedCallback signature for structured LoRaMAC events
+     * 
+     *  \param  event   the event which occurred
+     */
+    typedef void (* MacEventTracedCallback)(const LoRaMacEvent &event);
+    
 private:
     
     /**
@@ -300,6 +414,35 @@ private:
      */
     bool isPacketInQueue(uint32_t pid);
     
+    /**
+     *  Gets the ID of the packet a feedback header acknowledges, matching the low 16 bits sent in
+     *  the compact format against the packets in the queue
+     * 
+     *  \param  fheader the feedback header received
+     *  \param  pid     set to the ID of the packet acknowledged
+     * 
+     *  \return false if no queued packet, or more than one, matches the low 16 bits, true otherwise
+     */
+    bool ResolveFeedbackId(const LoRaMeshFeedbackHeader &fheader, uint64_t &pid) const;
+    
+    /**
+     *  Gets the ID of the packet acknowledged by a packet ID received in feedback
+     * 
+     *  \param  packet_id   the packet ID received
+     *  \param  compact     whether only the low 16 bits of the packet ID were received
+     *  \param  pid         set to the ID of the packet acknowledged
+     * 
+     *  \return false if no queued packet, or more than one, matches the low 16 bits, true otherwise
+     */
+    bool ResolveFeedbackId(uint64_t packet_id, bool compact, uint64_t &pid) const;
+    
+    /**
+     *  Checks if the packet queue is empty
+     * 
+     *  \return true if there are no packets queued for sending, false otherwise
+     */
+    bool IsQueueEmpty(void) const;
+    
     /**
      *  Gets a pointer to the next packet in the packet queue to be sent
      * 
@@ -307,6 +450,14 @@ private:
      */
     Ptr<Packet> GetNextPacketFromQueue(void);
     
+    /**
+     *  Gets the mesh header of the next packet in the packet queue to be sent, as read when
+     *  the packet was queued
+     * 
+     *  \return the mesh header of the next packet in the packet queue
+     */
+    const LoRaMeshHeader &GetNextHeaderFromQueue(void) const;
+    
     /**
      *  Adds a packet to the packet list of recently sent packets
      * 
@@ -314,20 +465,155 @@ private:
      */
     void AddToLastPacketList(Ptr<Packet> packet);
     
+    /**
+     *  Formats the position of the attached node for logging, only called from within log
+     *  statements so that the MobilityModel is not queried unless logging is enabled
+     * 
+     *  \return the position of the attached node as "x=.. y=.. z=.."
+     */
+    std::string GetPositionString(void) const;
+    
+    /**
+     *  Reports an event through the MacEvent trace source
+     */
+    void NotifyMacEvent(LoRaMacEventType type, uint32_t src, uint32_t dest, uint32_t fwd, uint64_t uid, float etx);
+    
+    /**
+     *  Packs the sender and receiver Node IDs of a routing table entry into its key
+     * 
+     *  \param  s   the sender Node ID
+     *  \param  r   the receiver Node ID
+     * 
+     *  \return the key of the entry in the routing table index
+     */
+    static uint64_t GetTableKey(uint32_t s, uint32_t r);
+    
+    /*  shortest path tree over the routing table rooted at one node    */
+    struct ShortestPathTree
+    {
+        std::unordered_map<uint32_t, float>     etx;        /*  ETX from the root to each reached node  */
+        std::unordered_map<uint32_t, uint32_t>  parent;     /*  previous hop on the shortest path   */
+    };
+    
+    typedef std::priority_queue<std::pair<float, uint32_t>, std::vector<std::pair<float, uint32_t>>, std::greater<std::pair<float, uint32_t>>> ETXHeap;
+    
+    /**
+     *  Runs Dijkstra's algorithm over the routing table from the nodes in the heap, keeping
+     *  the ETXs already in the tree as upper bounds
+     * 
+     *  \param  tree    the shortest path tree to be extended
+     *  \param  heap    the nodes (with their ETX) to continue the search from
+     */
+    void ExpandShortestPathTree(ShortestPathTree &tree, ETXHeap &heap);
+    
+    /**
+     *  Updates the routing graph and the cached shortest path trees after a routing table entry
+     *  has changed. Lower ETXs are propagated through the cached trees, while a higher ETX on a
+     *  link used by a tree drops that tree so that it is rebuilt on its next query.
+     * 
+     *  \param  s       the sender Node ID of the entry
+     *  \param  r       the receiver Node ID of the entry
+     *  \param  old_etx the previous ETX of the entry, infinity if it was added
+     *  \param  new_etx the new ETX of the entry, infinity if it was removed
+     */
+    void NotifyEntryChanged(uint32_t s, uint32_t r, float old_etx, float new_etx);
+    
+    /**
+     *  Applies a routing table entry advertised by a neighbour to the routing table
+     * 
+     *  \param  entry           the advertised entry, with the counter of the advertisement
+     *  \param  fwd             the Node ID of the neighbour which sent the advertisement
+     *  \param  estimateLink    whether the ETX of the link from the neighbour is updated from the
+     *                          counter as well (once per advertisement)
+     */
+    void ApplyRoutingEntry(RoutingTableEntry entry, uint32_t fwd, bool estimateLink);
+    
+    /**
+     *  Updates the ETX of the link from a neighbour from the number of its advertisements missed
+     *  since the last one received, removing the link if too many were missed
+     * 
+     *  \param  link    the routing table entry of the link from the neighbour
+     *  \param  last    the counter of the advertisement just received
+     */
+    void UpdateLinkEstimate(RoutingTableEntry link, uint8_t last);
+    
+    /**
+     *  Applies all of the entries of a multi-entry routing update, estimating the link from the
+     *  neighbour once for the advertisement
+     * 
+     *  \param  fwd     the Node ID of the neighbour which sent the advertisement
+     *  \param  lheader the routing list header of the advertisement
+     *  \param  uid     the packet ID of the advertisement (for the MacEvent trace)
+     */
+    void ApplyRoutingList(uint32_t fwd, const LoRaMeshRoutingListHeader &lheader, uint64_t uid);
+    
+    /**
+     *  Starts a new Trickle interval: the consistency counter is cleared and the point in the 
+     *  interval (in its second half) at which to decide whether to advertise is chosen
+     */
+    void StartTrickleInterval(void);
+    
+    /**
+     *  Decides whether to advertise in the next routing timeslot, unless enough consistent
+     *  routing updates have been heard in this interval
+     */
+    void TrickleTimerExpired(void);
+    
+    /**
+     *  Ends the current Trickle interval, doubling its length up to the maximum
+     */
+    void TrickleIntervalExpired(void);
+    
+    /**
+     *  Goes back to the minimum Trickle interval after an inconsistency (a change in the routing
+     *  table), unless already there
+     */
+    void ResetTrickleTimer(void);
+    
+    /**
+     *  Sends the routing table entries next in the advertisement order, as many as fit in the 
+     *  maximum routing payload, with the entry of this node itself always first
+     */
+    void SendRoutingList(void);
+    
     Ptr<LoRaPHY>        m_phy;
     Ptr<LoRaNetDevice>  m_device;
     
-    /*  routing table containing info the end device is aware of    */
-    std::deque<RoutingTableEntry> m_table;
-    
-    /*  Packets queued for sending  */
-    std::deque<Ptr<Packet>> m_packet_queue;
+    /*  routing table containing info the end device is aware of, kept dense so a random entry
+        can be picked for routing updates, and the position of each entry by (s, r) key    */
+    std::vector<RoutingTableEntry> m_table;
+    std::unordered_map<uint64_t, uint32_t> m_tableIndex;
+    
+    /*  the routing table as per sender adjacency lists (sender -> receiver -> etx) and the
+        shortest path trees computed over it, by root   */
+    std::unordered_map<uint32_t, std::map<uint32_t, float>> m_links;
+    std::unordered_map<uint32_t, ShortestPathTree> m_paths;
+    
+    /*  a packet queued for sending with its mesh header    */
+    struct QueuedPacket
+    {
+        Ptr<Packet>     packet;
+        LoRaMeshHeader  header;
+        bool            isFeedback;
+    };
+    
+    /*  Packets queued for sending, feedback packets are always sent before data packets, and
+        the queued packets with each packet ID in queue order   */
+    std::list<QueuedPacket> m_feedback_queue;
+    std::list<QueuedPacket> m_data_queue;
+    std::unordered_map<uint64_t, std::deque<std::list<QueuedPacket>::iterator>> m_queue_index;
+    
+    /*  number of queued copies of each packet ID, by the low 16 bits sent in compact feedback */
+    std::unordered_map<uint16_t, std::unordered_map<uint64_t, uint32_t>> m_short_index;
     
     /*  record of last packets sent */
     std::deque<uint64_t> m_last_packets;
     
     uint8_t m_last_counter;
     
+    /*  whether the timeslots have been started */
+    bool m_started;
+    
     /*  Min and Max range settings for random delay between packet timeslots    */
     uint32_t m_minDelay;
     uint32_t m_maxDelay;
@@ -336,8 +622,50 @@ private:
     uint32_t m_routingUpdateFreq;
     uint32_t m_routingUpdateCounter;
     
+    /*  whether the headers of packets sent are serialized in the compact format   */
+    bool m_compactHeaders;
+    
+    /*  multi-entry routing update settings, and the order in which entries are advertised by
+        (s, r) key, next to be advertised first  */
+    RoutingUpdateMode m_routingUpdateMode;
+    uint32_t m_maxRoutingPayload;
+    std::list<uint64_t> m_advertiseOrder;
+    std::unordered_map<uint64_t, std::list<uint64_t>::iterator> m_advertisePos;
+    
+    /*  size (bytes) of the dummy payloads of feedback packets and single-entry routing updates, 0 
+        for packets with only their headers    */
+    uint32_t m_feedbackPadding;
+    uint32_t m_routingPadding;
+    
+    /*  aggregated feedback settings, and the feedback packet still queued for each forwarding 
+        node to which more packet IDs can be added  */
+    bool m_aggregateFeedback;
+    uint32_t m_maxAggregatedFeedback;
+    std::unordered_map<uint32_t, uint64_t> m_feedbackFrames;
+    
+    /*  Trickle (RFC 6206) settings and state: the minimum interval (s), the number of times it 
+        can be doubled, the redundancy constant k (0 for no suppression), the current interval, 
+        the number of consistent routing updates heard in it and whether to advertise in the 
+        next routing timeslot   */
+    bool m_trickleEnabled;
+    uint32_t m_trickleMinInterval;
+    uint32_t m_trickleDoublings;
+    uint32_t m_trickleRedundancy;
+    Time m_trickleInterval;
+    uint32_t m_trickleCounter;
+    bool m_trickleAdvertise;
+    EventId m_trickleTimer;
+    EventId m_trickleIntervalEnd;
+    
+    /*  incremented on every change to the ETX of a routing table entry */
+    uint64_t m_tableVersion;
+    
+    /*  random variable for timeslot delays and routing update choice   */
+    Ptr<UniformRandomVariable> m_rng;
+    
     TracedCallback<Ptr<Packet>> m_rxPacketSniffer;
     TracedCallback<Ptr<Packet>> m_txPacketSniffer;
+    TracedCallback<const LoRaMacEvent &> m_macEvent;
 };
 
 }
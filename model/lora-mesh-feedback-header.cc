@@ -26,6 +26,7 @@ namespace lora_mesh {
 LoRaMeshFeedbackHeader::LoRaMeshFeedbackHeader()
 {
     m_packetid = 0;
+    m_compact = false;
 }
     
 LoRaMeshFeedbackHeader::~LoRaMeshFeedbackHeader()
@@ -61,15 +62,34 @@ LoRaMeshFeedbackHeader::GetPacketId(void) const
     return m_packetid;
 }
     
+void
+LoRaMeshFeedbackHeader::SetCompact(bool compact)
+{
+    m_compact = compact;
+    return;
+}
+
+bool
+LoRaMeshFeedbackHeader::IsCompact(void) const
+{
+    return m_compact;
+}
+    
 uint32_t
 LoRaMeshFeedbackHeader::GetSerializedSize(void) const
 {
-    return 8;
+    return m_compact ? 2 : 8;
 }
  
 void
 LoRaMeshFeedbackHeader::Serialize(Buffer::Iterator start) const
 {
+    if (m_compact)
+    {
+        start.WriteU16((uint16_t)m_packetid);
+        return;
+    }
+    
     start.WriteU64(m_packetid);
     return;
 }
@@ -77,7 +97,14 @@ LoRaMeshFeedbackHeader::Serialize(Buffer::Iterator start) const
 uint32_t
 LoRaMeshFeedbackHeader::Deserialize(Buffer::Iterator start)
 {
-    m_packetid = start.ReadU64();
+    if (m_compact)
+    {
+        m_packetid = start.ReadU16();
+    }
+    else
+    {
+        m_packetid = start.ReadU64();
+    }
     
     return GetSerializedSize();
 }
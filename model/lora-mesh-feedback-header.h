@@ -31,6 +31,9 @@ namespace lora_mesh {
  *  
  *  This header is used to add the packet ID of the packet for which the feedback packet was
  *  made which is not included in the general LoRa mesh header.
+ * 
+ *  In the compact format only the low 16 bits of the packet ID are sent, which the receiving
+ *  LoRaMAC matches against the packets in its queue.
  */
 class LoRaMeshFeedbackHeader : public Header
 {
@@ -62,7 +65,21 @@ public:
      */
     uint64_t GetPacketId (void) const;
     
+    /**
+     *  Sets whether the header is serialized in the compact format. The format can't be detected,
+     *  so it must be set from the LoRaMeshHeader before deserializing.
+     * 
+     *  \param  compact true for the compact format, false for the fixed format
+     */
+    void SetCompact (bool compact);
+    
+    /**
+     *  \return true if the header is serialized in the compact format, false otherwise
+     */
+    bool IsCompact (void) const;
+    
 private:
+    bool m_compact;
     uint64_t m_packetid;
 };
     
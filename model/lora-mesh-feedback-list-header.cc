@@ -0,0 +1,204 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 Sanjay Charran
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sanjay Charran <sanjaycharran@gmail.com>
+ */
+
+#include "ns3/lora-mesh-feedback-list-header.h"
+#include "ns3/lora-mesh-header.h"
+
+#include <algorithm>
+
+namespace ns3 {
+namespace lora_mesh {
+
+LoRaMeshFeedbackListHeader::LoRaMeshFeedbackListHeader()
+{
+    m_compact = false;
+}
+
+LoRaMeshFeedbackListHeader::~LoRaMeshFeedbackListHeader()
+{
+}
+
+TypeId
+LoRaMeshFeedbackListHeader::GetTypeId(void)
+{
+    static TypeId tid = TypeId("ns3::LoRaMeshFeedbackListHeader")
+        .SetParent<Header>()
+        .SetGroupName("lora_mesh");
+        
+    return tid;
+}
+
+TypeId
+LoRaMeshFeedbackListHeader::GetInstanceTypeId(void) const
+{
+    return GetTypeId();
+}
+
+bool
+LoRaMeshFeedbackListHeader::AddPacketId(uint64_t packet_id)
+{
+    if (m_packetids.size() >= MAXIMUM_FEEDBACK_LIST_ENTRIES)
+    {
+        return false;
+    }
+    
+    /*  keep the packet IDs sorted so only small differences are sent   */
+    m_packetids.insert(std::upper_bound(m_packetids.begin(), m_packetids.end(), packet_id), packet_id);
+    return true;
+}
+
+const std::vector<uint64_t> &
+LoRaMeshFeedbackListHeader::GetPacketIds(void) const
+{
+    return m_packetids;
+}
+
+void
+LoRaMeshFeedbackListHeader::SetCompact(bool compact)
+{
+    m_compact = compact;
+    return;
+}
+
+bool
+LoRaMeshFeedbackListHeader::IsCompact(void) const
+{
+    return m_compact;
+}
+
+uint32_t
+LoRaMeshFeedbackListHeader::GetSerializedSize(void) const
+{
+    /*  1(number of packet IDs) + first packet ID + differences  */
+    uint32_t size = 1;
+    
+    if (m_packetids.empty())
+    {
+        return size;
+    }
+    
+    size += m_compact ? 2 : 8;
+    
+    for (uint32_t i = 1;i < m_packetids.size();i++)
+    {
+        size += LoRaMeshHeader::GetVarintSize(GetDifference(i));
+    }
+    
+    return size;
+}
+
+void
+LoRaMeshFeedbackListHeader::Serialize(Buffer::Iterator start) const
+{
+    start.WriteU8((uint8_t)m_packetids.size());
+    
+    if (m_packetids.empty())
+    {
+        return;
+    }
+    
+    if (m_compact)
+    {
+        start.WriteU16((uint16_t)m_packetids[0]);
+    }
+    else
+    {
+        start.WriteU64(m_packetids[0]);
+    }
+    
+    for (uint32_t i = 1;i < m_packetids.size();i++)
+    {
+        LoRaMeshHeader::WriteVarint(start, GetDifference(i));
+    }
+    
+    return;
+}
+
+uint32_t
+LoRaMeshFeedbackListHeader::Deserialize(Buffer::Iterator start)
+{
+    uint8_t n = start.ReadU8();
+    uint32_t size = 1;
+    uint32_t diff;
+    uint64_t packet_id;
+    
+    m_packetids.clear();
+    
+    if (n == 0)
+    {
+        return size;
+    }
+    
+    m_packetids.reserve(n);
+    packet_id = m_compact ? start.ReadU16() : start.ReadU64();
+    size += m_compact ? 2 : 8;
+    m_packetids.push_back(packet_id);
+    
+    for (uint8_t i = 1;i < n;i++)
+    {
+        diff = LoRaMeshHeader::ReadVarint(start);
+        size += LoRaMeshHeader::GetVarintSize(diff);
+        packet_id += diff;
+        
+        /*  the low 16 bits may wrap, so the size is counted as it is read  */
+        if (m_compact)
+        {
+            packet_id &= 0xffff;
+        }
+        
+        m_packetids.push_back(packet_id);
+    }
+    
+    return size;
+}
+
+uint32_t
+LoRaMeshFeedbackListHeader::GetDifference(uint32_t i) const
+{
+    uint64_t diff = m_packetids[i] - m_packetids[i - 1];
+    
+    /*  only the low 16 bits are read back, so a wide gap costs no more than a small one  */
+    if (m_compact)
+    {
+        diff &= 0xffff;
+    }
+    
+    return (uint32_t)diff;
+}
+
+void
+LoRaMeshFeedbackListHeader::Print(std::ostream &os) const
+{
+    os << "Feedback for Packets:";
+    
+    std::vector<uint64_t>::const_iterator it = m_packetids.begin();
+    
+    for (;it != m_packetids.end();++it)
+    {
+        os << " " << *it;
+    }
+    
+    os << std::endl;
+    
+    return;
+}
+
+}
+}
@@ -0,0 +1,100 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 Sanjay Charran
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sanjay Charran <sanjaycharran@gmail.com>
+ */
+
+#ifndef __LORA_MESH_FEEDBACK_LIST_HEADER_H__
+#define __LORA_MESH_FEEDBACK_LIST_HEADER_H__
+
+#include "ns3/header.h"
+
+#include <vector>
+
+#define MAXIMUM_FEEDBACK_LIST_ENTRIES   255
+
+namespace ns3 {
+namespace lora_mesh {
+
+/**
+ *  \brief  Packet header for LoRa mesh feedback packets acknowledging several packets at once
+ * 
+ *  Follows a LoRaMeshHeader of type FEEDBACKS. The packet IDs are kept in ascending order and sent
+ *  as the first packet ID followed by the (varint) difference of each packet ID from the one 
+ *  before, so that packets received close together cost a byte or so each. In the compact format 
+ *  the first packet ID is cut to its low 16 bits as in LoRaMeshFeedbackHeader, and so are the 
+ *  packet IDs read back.
+ */
+class LoRaMeshFeedbackListHeader : public Header
+{
+public:
+    
+    LoRaMeshFeedbackListHeader();
+    ~LoRaMeshFeedbackListHeader();
+    
+    static TypeId GetTypeId(void);
+    TypeId GetInstanceTypeId(void) const;
+    
+    /*  virtual funcs   */
+    uint32_t GetSerializedSize(void) const;
+    uint32_t Deserialize(Buffer::Iterator start);
+    void Serialize(Buffer::Iterator start) const;
+    void Print(std::ostream &os) const;
+    
+    /**
+     *  Adds the packet ID of a packet being acknowledged to the header
+     * 
+     *  \param  packet_id   the packet ID to be added
+     * 
+     *  \return false if the header already holds the maximum number of packet IDs, true otherwise
+     */
+    bool AddPacketId(uint64_t packet_id);
+    
+    /**
+     *  \return the packet IDs held by the header, in ascending order
+     */
+    const std::vector<uint64_t> &GetPacketIds(void) const;
+    
+    /**
+     *  Sets whether the header is serialized in the compact format. The format can't be detected,
+     *  so it must be set from the LoRaMeshHeader before deserializing.
+     * 
+     *  \param  compact true for the compact format, false for the fixed format
+     */
+    void SetCompact(bool compact);
+    
+    /**
+     *  \return true if the header is serialized in the compact format, false otherwise
+     */
+    bool IsCompact(void) const;
+    
+private:
+    /**
+     *  \param  i   index of a packet ID other than the first
+     * 
+     *  \return the difference sent for the packet ID, modulo 0x10000 in the compact format
+     */
+    uint32_t GetDifference(uint32_t i) const;
+    
+    bool m_compact;
+    std::vector<uint64_t> m_packetids;
+};
+
+}
+}
+
+#endif  /*  __LORA_MESH_FEEDBACK_LIST_HEADER_H__ */
@@ -33,6 +33,7 @@ LoRaMeshHeader::LoRaMeshHeader()
     m_dest = 0;
     m_fwd = 0;
     m_type = DIRECTED;
+    m_compact = false;
 }
     
 LoRaMeshHeader::~LoRaMeshHeader()
@@ -107,9 +108,77 @@ LoRaMeshHeader::GetFwd(void) const
     return m_fwd;
 }
 
+void
+LoRaMeshHeader::SetCompact(bool compact)
+{
+    m_compact = compact;
+    return;
+}
+
+bool
+LoRaMeshHeader::IsCompact(void) const
+{
+    return m_compact;
+}
+
+uint32_t
+LoRaMeshHeader::GetVarintSize(uint32_t value)
+{
+    uint32_t size = 1;
+    
+    while (value >= 0x80)
+    {
+        value >>= 7;
+        size++;
+    }
+    
+    return size;
+}
+
+void
+LoRaMeshHeader::WriteVarint(Buffer::Iterator &i, uint32_t value)
+{
+    /*  least significant 7 bits first, top bit set while more bytes follow */
+    while (value >= 0x80)
+    {
+        i.WriteU8((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    
+    i.WriteU8((uint8_t)value);
+    
+    return;
+}
+
+uint32_t
+LoRaMeshHeader::ReadVarint(Buffer::Iterator &i)
+{
+    uint32_t value = 0;
+    uint8_t byte;
+    
+    for (uint32_t shift = 0;shift < 32;shift += 7)
+    {
+        byte = i.ReadU8();
+        value |= (uint32_t)(byte & 0x7f) << shift;
+        
+        if (!(byte & 0x80))
+        {
+            break;
+        }
+    }
+    
+    return value;
+}
+
 uint32_t
 LoRaMeshHeader::GetSerializedSize(void) const
 {
+    if (m_compact)
+    {
+        /*  1(type and flags) + varint(src) + varint(dest) + varint(fwd)   */
+        return 1 + GetVarintSize(m_src) + GetVarintSize(m_dest) + GetVarintSize(m_fwd);
+    }
+    
     /*  4(src) + 4(dest) + 4(fwd) + 1(type)  = 13 */
     /*  type is 1 byte since only 4 options in enum  */
     return (uint32_t)13;
@@ -118,6 +187,16 @@ LoRaMeshHeader::GetSerializedSize(void) const
 void
 LoRaMeshHeader::Serialize(Buffer::Iterator start) const
 {
+    if (m_compact)
+    {
+        start.WriteU8(LORA_MESH_HEADER_COMPACT | ((uint8_t)m_type & LORA_MESH_HEADER_TYPE_MASK));
+        WriteVarint(start, m_src);
+        WriteVarint(start, m_dest);
+        WriteVarint(start, m_fwd);
+        
+        return;
+    }
+    
     start.WriteU8((uint8_t)m_type);
     start.WriteU32(m_src);
     start.WriteU32(m_dest);
@@ -129,10 +208,25 @@ LoRaMeshHeader::Serialize(Buffer::Iterator start) const
 uint32_t
 LoRaMeshHeader::Deserialize(Buffer::Iterator start)
 {
-    m_type = (MsgType)(start.ReadU8());
-    m_src = start.ReadU32();
-    m_dest = start.ReadU32();
-    m_fwd = start.ReadU32();
+    uint8_t first = start.ReadU8();
+    
+    /*  the fixed format's type byte never has the compact flag set */
+    m_compact = (first & LORA_MESH_HEADER_COMPACT) != 0;
+    
+    if (m_compact)
+    {
+        m_type = (MsgType)(first & LORA_MESH_HEADER_TYPE_MASK);
+        m_src = ReadVarint(start);
+        m_dest = ReadVarint(start);
+        m_fwd = ReadVarint(start);
+    }
+    else
+    {
+        m_type = (MsgType)first;
+        m_src = start.ReadU32();
+        m_dest = start.ReadU32();
+        m_fwd = start.ReadU32();
+    }
     
     return GetSerializedSize();
 }
@@ -140,7 +234,28 @@ LoRaMeshHeader::Deserialize(Buffer::Iterator start)
 void 
 LoRaMeshHeader::Print(std::ostream &os) const
 {
-    os << "Message Type: " << ((m_type == ROUTING_UPDATE)?"ROUTING_UPDATE":(m_type == DIRECTED?"DIRECTED":"FEEDBACK")) << std::endl;
+    os << "Message Type: ";
+    
+    switch (m_type)
+    {
+        case ROUTING_UPDATE:
+            os << "ROUTING_UPDATE";
+            break;
+        case DIRECTED:
+            os << "DIRECTED";
+            break;
+        case FEEDBACK:
+            os << "FEEDBACK";
+            break;
+        case ROUTING_UPDATES:
+            os << "ROUTING_UPDATES";
+            break;
+        case FEEDBACKS:
+            os << "FEEDBACKS";
+            break;
+    }
+    
+    os << std::endl;
     os << "Source ID: " << m_src << std::endl;
     os << "Destination ID: " << m_dest << std::endl;
     os << "Last Forwarder: " << m_fwd << std::endl;
@@ -23,6 +23,9 @@
 
 #include "ns3/header.h"
 
+#define LORA_MESH_HEADER_COMPACT    0x80    /*  set in the first byte of compact headers    */
+#define LORA_MESH_HEADER_TYPE_MASK  0x0f
+
 namespace ns3 {
 namespace lora_mesh {
  
@@ -35,7 +38,11 @@ enum MsgType
     
     DIRECTED = 1,           /*  packet being sent to only a specific node   */
 
-    FEEDBACK = 2            /*  feedback for packet reception   */
+    FEEDBACK = 2,           /*  feedback for packet reception   */
+    
+    ROUTING_UPDATES = 3,    /*  broadcasting several routing table entries at once  */
+    
+    FEEDBACKS = 4           /*  feedback for the reception of several packets at once   */
 };
     
 /**
@@ -45,6 +52,11 @@ enum MsgType
  *  original source, destination and last forwarding node IDs. Another important parameter in 
  *  the header is the packet type which can be used identify the existence of other LoRa mesh 
  *  headers
+ * 
+ *  The header is either serialized in the original fixed format (1 byte type, three 4 byte node
+ *  IDs) or in a compact format: the type nibble packed with flags into the first byte, followed by
+ *  the node IDs as varints (7 bits per byte, 1 byte for IDs below 128). The compact flag in the
+ *  first byte makes either format readable without knowing which one was used.
  */
 class LoRaMeshHeader : public Header
 {
@@ -117,7 +129,38 @@ public:
      */
     uint32_t GetFwd(void) const;
     
+    /**
+     *  Sets whether the header is serialized in the compact format
+     * 
+     *  \param  compact true for the compact format, false for the fixed format
+     */
+    void SetCompact(bool compact);
+    
+    /**
+     *  Checks whether the header is serialized in the compact format, which for a deserialized
+     *  header is the format it was received in
+     * 
+     *  \return true if the compact format is used, false otherwise
+     */
+    bool IsCompact(void) const;
+    
+    /**
+     *  \return the number of bytes the value takes as a varint
+     */
+    static uint32_t GetVarintSize(uint32_t value);
+    
+    /**
+     *  Writes a value as a varint, shared by the headers using the compact format
+     */
+    static void WriteVarint(Buffer::Iterator &i, uint32_t value);
+    
+    /**
+     *  \return the value of the varint read
+     */
+    static uint32_t ReadVarint(Buffer::Iterator &i);
+    
 private:
+    bool m_compact;
     MsgType m_type;
     uint32_t m_src;
     uint32_t m_dest;
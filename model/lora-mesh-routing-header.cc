@@ -20,6 +20,8 @@
 
 #include "ns3/lora-mesh-routing-header.h"
 
+#include <cmath>
+
 namespace ns3 {
 namespace lora_mesh {
  
@@ -27,6 +29,7 @@ LoRaMeshRoutingHeader::LoRaMeshRoutingHeader()
 {    
     m_etx = 0;
     m_last = 0;
+    m_compact = false;
 }
  
 LoRaMeshRoutingHeader::~LoRaMeshRoutingHeader()
@@ -75,9 +78,42 @@ LoRaMeshRoutingHeader::GetLast(void) const
     return m_last;
 }
 
+void
+LoRaMeshRoutingHeader::SetCompact(bool compact)
+{
+    m_compact = compact;
+    return;
+}
+
+bool
+LoRaMeshRoutingHeader::IsCompact(void) const
+{
+    return m_compact;
+}
+
+uint8_t
+LoRaMeshRoutingHeader::QuantizeETX(float etx)
+{
+    float steps = std::round(etx * LORA_MESH_ETX_STEPS);
+    
+    return (steps <= 0) ? 0 : ((steps >= 255) ? 255 : (uint8_t)steps);
+}
+
+float
+LoRaMeshRoutingHeader::DequantizeETX(uint8_t steps)
+{
+    return (float)steps / LORA_MESH_ETX_STEPS;
+}
+
 uint32_t
 LoRaMeshRoutingHeader::GetSerializedSize(void) const
 {
+    if (m_compact)
+    {
+        /*  1(quantized etx) + 1(last) = 2 */
+        return (uint32_t)2;
+    }
+    
     /*  should be 4(etx) + 1(last) = 5 */
     return (uint32_t)(sizeof(float) + 1);
 }
@@ -85,6 +121,14 @@ LoRaMeshRoutingHeader::GetSerializedSize(void) const
 void
 LoRaMeshRoutingHeader::Serialize(Buffer::Iterator start) const
 {
+    if (m_compact)
+    {
+        start.WriteU8(QuantizeETX(m_etx));
+        start.WriteU8(m_last);
+        
+        return;
+    }
+    
     start.Write((uint8_t *)&m_etx, sizeof(float));
     start.WriteU8(m_last);
     
@@ -94,6 +138,14 @@ LoRaMeshRoutingHeader::Serialize(Buffer::Iterator start) const
 uint32_t
 LoRaMeshRoutingHeader::Deserialize(Buffer::Iterator start)
 {
+    if (m_compact)
+    {
+        m_etx = DequantizeETX(start.ReadU8());
+        m_last = start.ReadU8();
+        
+        return GetSerializedSize();
+    }
+    
     start.Read((uint8_t *)&m_etx, sizeof(float));
     m_last = start.ReadU8();
     
@@ -23,6 +23,8 @@
 
 #include "ns3/header.h"
 
+#define LORA_MESH_ETX_STEPS     16      /*  quantization steps per unit of ETX in the compact format    */
+
 namespace ns3 {
 namespace lora_mesh {
 
@@ -33,6 +35,9 @@ namespace lora_mesh {
  *  by LoRa mesh nodes that is not already contained in the the general LoRa mesh header. These two
  *  missing parameters are the expected transmission count (ETX) and the counter value the last time 
  *  this entry was sent by the node
+ * 
+ *  In the compact format the ETX is quantized to 8 bits in steps of 1/16 (up to 15.9375, beyond
+ *  the largest ETX a LoRaMAC keeps), so whole ETX values are carried exactly.
  */
 class LoRaMeshRoutingHeader : public Header
 {
@@ -78,7 +83,31 @@ public:
      */
     uint8_t GetLast(void) const;
     
+    /**
+     *  Sets whether the header is serialized in the compact format. Unlike LoRaMeshHeader the
+     *  format can't be detected, so it must be set from the LoRaMeshHeader before deserializing.
+     * 
+     *  \param  compact true for the compact format, false for the fixed format
+     */
+    void SetCompact(bool compact);
+    
+    /**
+     *  \return true if the header is serialized in the compact format, false otherwise
+     */
+    bool IsCompact(void) const;
+    
+    /**
+     *  \return the ETX quantized to 8 bits for the compact format, saturating at 255
+     */
+    static uint8_t QuantizeETX(float etx);
+    
+    /**
+     *  \return the ETX represented by a quantized value
+     */
+    static float DequantizeETX(uint8_t steps);
+    
 private:
+    bool m_compact;
     float m_etx;
     uint8_t m_last;
 };
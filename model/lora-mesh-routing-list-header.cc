@@ -0,0 +1,202 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 Sanjay Charran
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sanjay Charran <sanjaycharran@gmail.com>
+ */
+
+#include "ns3/lora-mesh-routing-list-header.h"
+#include "ns3/lora-mesh-routing-header.h"
+#include "ns3/lora-mesh-header.h"
+
+namespace ns3 {
+namespace lora_mesh {
+
+LoRaMeshRoutingListHeader::LoRaMeshRoutingListHeader()
+{
+    m_compact = false;
+    m_last = 0;
+}
+
+LoRaMeshRoutingListHeader::~LoRaMeshRoutingListHeader()
+{
+}
+
+TypeId
+LoRaMeshRoutingListHeader::GetTypeId(void)
+{
+    static TypeId tid = TypeId("ns3::LoRaMeshRoutingListHeader")
+        .SetParent<Header>()
+        .SetGroupName("lora_mesh");
+        
+    return tid;
+}
+
+TypeId
+LoRaMeshRoutingListHeader::GetInstanceTypeId(void) const
+{
+    return GetTypeId();
+}
+
+void
+LoRaMeshRoutingListHeader::SetLast(uint8_t last)
+{
+    m_last = last;
+    return;
+}
+
+uint8_t
+LoRaMeshRoutingListHeader::GetLast(void) const
+{
+    return m_last;
+}
+
+bool
+LoRaMeshRoutingListHeader::AddEntry(const RoutingListEntry &entry)
+{
+    if (m_entries.size() >= MAXIMUM_ROUTING_LIST_ENTRIES)
+    {
+        return false;
+    }
+    
+    m_entries.push_back(entry);
+    return true;
+}
+
+const std::vector<RoutingListEntry> &
+LoRaMeshRoutingListHeader::GetEntries(void) const
+{
+    return m_entries;
+}
+
+void
+LoRaMeshRoutingListHeader::SetCompact(bool compact)
+{
+    m_compact = compact;
+    return;
+}
+
+bool
+LoRaMeshRoutingListHeader::IsCompact(void) const
+{
+    return m_compact;
+}
+
+uint32_t
+LoRaMeshRoutingListHeader::GetEntrySize(const RoutingListEntry &entry, bool compact)
+{
+    if (compact)
+    {
+        /*  varint(s) + varint(r) + 1(quantized etx)   */
+        return LoRaMeshHeader::GetVarintSize(entry.s) + LoRaMeshHeader::GetVarintSize(entry.r) + 1;
+    }
+    
+    /*  4(s) + 4(r) + 4(etx) = 12   */
+    return (uint32_t)(8 + sizeof(float));
+}
+
+uint32_t
+LoRaMeshRoutingListHeader::GetSerializedSize(void) const
+{
+    /*  1(last) + 1(number of entries) + entries    */
+    uint32_t size = 2;
+    
+    std::vector<RoutingListEntry>::const_iterator it = m_entries.begin();
+    
+    for (;it != m_entries.end();++it)
+    {
+        size += GetEntrySize(*it, m_compact);
+    }
+    
+    return size;
+}
+
+void
+LoRaMeshRoutingListHeader::Serialize(Buffer::Iterator start) const
+{
+    start.WriteU8(m_last);
+    start.WriteU8((uint8_t)m_entries.size());
+    
+    std::vector<RoutingListEntry>::const_iterator it = m_entries.begin();
+    
+    for (;it != m_entries.end();++it)
+    {
+        if (m_compact)
+        {
+            LoRaMeshHeader::WriteVarint(start, it->s);
+            LoRaMeshHeader::WriteVarint(start, it->r);
+            start.WriteU8(LoRaMeshRoutingHeader::QuantizeETX(it->etx));
+        }
+        else
+        {
+            start.WriteU32(it->s);
+            start.WriteU32(it->r);
+            start.Write((const uint8_t *)&it->etx, sizeof(float));
+        }
+    }
+    
+    return;
+}
+
+uint32_t
+LoRaMeshRoutingListHeader::Deserialize(Buffer::Iterator start)
+{
+    RoutingListEntry entry;
+    
+    m_last = start.ReadU8();
+    uint8_t n = start.ReadU8();
+    
+    m_entries.clear();
+    m_entries.reserve(n);
+    
+    for (uint8_t i = 0;i < n;i++)
+    {
+        if (m_compact)
+        {
+            entry.s = LoRaMeshHeader::ReadVarint(start);
+            entry.r = LoRaMeshHeader::ReadVarint(start);
+            entry.etx = LoRaMeshRoutingHeader::DequantizeETX(start.ReadU8());
+        }
+        else
+        {
+            entry.s = start.ReadU32();
+            entry.r = start.ReadU32();
+            start.Read((uint8_t *)&entry.etx, sizeof(float));
+        }
+        
+        m_entries.push_back(entry);
+    }
+    
+    return GetSerializedSize();
+}
+
+void
+LoRaMeshRoutingListHeader::Print(std::ostream &os) const
+{
+    os << "Last Counter: " << (uint32_t)m_last << std::endl;
+    
+    std::vector<RoutingListEntry>::const_iterator it = m_entries.begin();
+    
+    for (;it != m_entries.end();++it)
+    {
+        os << it->s << "->" << it->r << " (ETX: " << it->etx << ")" << std::endl;
+    }
+    
+    return;
+}
+
+}
+}
@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 Sanjay Charran
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sanjay Charran <sanjaycharran@gmail.com>
+ */
+
+#ifndef __LORA_MESH_ROUTING_LIST_HEADER_H__
+#define __LORA_MESH_ROUTING_LIST_HEADER_H__
+
+#include "ns3/header.h"
+
+#include <vector>
+
+#define MAXIMUM_ROUTING_LIST_ENTRIES    255
+
+namespace ns3 {
+namespace lora_mesh {
+
+/*
+ *  A routing table entry carried by a LoRaMeshRoutingListHeader
+ */
+struct RoutingListEntry
+{
+    uint32_t    s;      /*  id's for sender and receiver    */
+    uint32_t    r;
+    float       etx;
+};
+
+/**
+ *  \brief  Packet header for LoRa mesh routing updates carrying several routing table entries
+ * 
+ *  Follows a LoRaMeshHeader of type ROUTING_UPDATES. It holds the counter value of the 
+ *  advertisement, shared by all of its entries, followed by the entries themselves. In the compact
+ *  format the node IDs are varints and the ETX is quantized to 8 bits as in LoRaMeshRoutingHeader.
+ */
+class LoRaMeshRoutingListHeader : public Header
+{
+public:
+    
+    LoRaMeshRoutingListHeader();
+    ~LoRaMeshRoutingListHeader();
+    
+    static TypeId GetTypeId(void);
+    TypeId GetInstanceTypeId(void) const;
+    
+    /*  virtual funcs   */
+    uint32_t GetSerializedSize(void) const;
+    uint32_t Deserialize(Buffer::Iterator start);
+    void Serialize(Buffer::Iterator start) const;
+    void Print(std::ostream &os) const;
+    
+    /**
+     *  Sets the value of the counter when the advertisement was sent
+     * 
+     *  \param last the value of the counter when the advertisement was sent
+     */
+    void SetLast(uint8_t last);
+    
+    /**
+     *  Gets the value of the counter when the advertisement was sent
+     * 
+     *  \return the value of the counter when the advertisement was sent
+     */
+    uint8_t GetLast(void) const;
+    
+    /**
+     *  Adds a routing table entry to the header
+     * 
+     *  \param  entry   the entry to be added
+     * 
+     *  \return false if the header already holds the maximum number of entries, true otherwise
+     */
+    bool AddEntry(const RoutingListEntry &entry);
+    
+    /**
+     *  \return the routing table entries held by the header
+     */
+    const std::vector<RoutingListEntry> &GetEntries(void) const;
+    
+    /**
+     *  Sets whether the header is serialized in the compact format. The format can't be detected,
+     *  so it must be set from the LoRaMeshHeader before deserializing.
+     * 
+     *  \param  compact true for the compact format, false for the fixed format
+     */
+    void SetCompact(bool compact);
+    
+    /**
+     *  \return true if the header is serialized in the compact format, false otherwise
+     */
+    bool IsCompact(void) const;
+    
+    /**
+     *  Gets the number of bytes an entry adds to the header
+     * 
+     *  \param  entry   the entry to be added
+     *  \param  compact whether the compact format is used
+     * 
+     *  \return the size (bytes) of the serialized entry
+     */
+    static uint32_t GetEntrySize(const RoutingListEntry &entry, bool compact);
+    
+private:
+    bool m_compact;
+    uint8_t m_last;
+    std::vector<RoutingListEntry> m_entries;
+};
+
+}
+}
+
+#endif  /*  __LORA_MESH_ROUTING_LIST_HEADER_H__ */
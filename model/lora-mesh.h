@@ -23,6 +23,10 @@
 /*  Header used for convenience of using module */
 
 #include "ns3/ascii-helper-for-lora.h"
+#include "ns3/lora-mac-helper.h"
+#include "ns3/lora-phy-helper.h"
+#include "ns3/lora-mesh-helper.h"
+#include "ns3/binary-trace-helper-for-lora.h"
 #include "ns3/lora-phy.h"
 #include "ns3/lora-mac.h"
 #include "ns3/lora-net-device.h"
@@ -22,9 +22,14 @@
 
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
 
 #include "ns3/lora-phy.h"
 
+#include <limits>
+
 NS_LOG_COMPONENT_DEFINE("LoRaPHY");
 
 namespace ns3 {
@@ -36,6 +41,82 @@ LoRaPHY::GetTypeId(void)
     static TypeId tid =  TypeId("ns3::LoRaPHY")
         .SetParent<Object>()
         .SetGroupName("lora_mesh")
+        .AddAttribute("TxPower",
+                      "Transmission power (dBm)",
+                      DoubleValue(14),
+                      MakeDoubleAccessor(&LoRaPHY::SetTxPower, &LoRaPHY::GetTxPower),
+                      MakeDoubleChecker<double>())
+        .AddAttribute("TxFreq",
+                      "Frequency (MHz) used for transmission",
+                      DoubleValue(868.1),
+                      MakeDoubleAccessor(&LoRaPHY::SetTxFreq, &LoRaPHY::GetTxFreq),
+                      MakeDoubleChecker<double>(0))
+        .AddAttribute("TxSF",
+                      "Spreading factor used for transmission",
+                      UintegerValue(7),
+                      MakeUintegerAccessor(&LoRaPHY::SetTxSF, &LoRaPHY::GetTxSF),
+                      MakeUintegerChecker<uint8_t>(MINIMUM_LORA_SPREADING_FACTOR, MAXIMUM_LORA_SPREADING_FACTOR))
+        .AddAttribute("TxBW",
+                      "Bandwidth (Hz) used for transmission",
+                      DoubleValue(125000),
+                      MakeDoubleAccessor(&LoRaPHY::SetTxBW, &LoRaPHY::GetTxBW),
+                      MakeDoubleChecker<double>(0))
+        .AddAttribute("TxPreambles",
+                      "Number of preamble symbols sent before a LoRa signal",
+                      UintegerValue(8),
+                      MakeUintegerAccessor(&LoRaPHY::SetTxPreamples, &LoRaPHY::GetTxPreamples),
+                      MakeUintegerChecker<uint32_t>())
+        .AddAttribute("TxCodingRate",
+                      "Coding rate used for transmission (1 to 4 for 4/5 to 4/8)",
+                      UintegerValue(1),
+                      MakeUintegerAccessor(&LoRaPHY::SetTxCodingRate, &LoRaPHY::GetCodingRate),
+                      MakeUintegerChecker<uint8_t>(1, 4))
+        .AddAttribute("HeaderDisabled",
+                      "Whether the explicit PHY header is left out of transmissions",
+                      BooleanValue(false),
+                      MakeBooleanAccessor(&LoRaPHY::SetHeaderDisabled, &LoRaPHY::IsHeaderDisabled),
+                      MakeBooleanChecker())
+        .AddAttribute("CRCEnabled",
+                      "Whether a payload CRC is added to transmissions",
+                      BooleanValue(true),
+                      MakeBooleanAccessor(&LoRaPHY::SetCRCEnabled, &LoRaPHY::IsCRCEnabled),
+                      MakeBooleanChecker())
+        .AddAttribute("AutoLowDataRateOpt",
+                      "Whether low data rate optimization is enabled automatically when the symbol "
+                      "time exceeds 16ms, overriding LowDataRateOpt",
+                      BooleanValue(true),
+                      MakeBooleanAccessor(&LoRaPHY::SetAutoLowDataRateOpt, &LoRaPHY::IsAutoLowDataRateOptEnabled),
+                      MakeBooleanChecker())
+        .AddAttribute("LowDataRateOpt",
+                      "Whether low data rate optimization is used for transmission. An explicit "
+                      "value is ignored while AutoLowDataRateOpt is enabled, and reading the "
+                      "attribute gives the value in use",
+                      BooleanValue(false),
+                      MakeBooleanAccessor(&LoRaPHY::SetLowDataRateOpt, &LoRaPHY::IsLowDataRateOptEnabled),
+                      MakeBooleanChecker())
+        .AddAttribute("RxSens",
+                      "Receiver sensitivity (dBm)",
+                      DoubleValue(-124),
+                      MakeDoubleAccessor(&LoRaPHY::SetRxSens, &LoRaPHY::GetRxSens),
+                      MakeDoubleChecker<double>())
+        .AddAttribute("RxFreq",
+                      "Frequency (MHz) the receiver listens on",
+                      DoubleValue(868.1),
+                      MakeDoubleAccessor(&LoRaPHY::SetRxFreq, &LoRaPHY::GetRxFreq),
+                      MakeDoubleChecker<double>(0))
+        .AddAttribute("RxSF",
+                      "Spreading factor the receiver listens for",
+                      UintegerValue(7),
+                      MakeUintegerAccessor(&LoRaPHY::SetRxSF, &LoRaPHY::GetRxSF),
+                      MakeUintegerChecker<uint8_t>(MINIMUM_LORA_SPREADING_FACTOR, MAXIMUM_LORA_SPREADING_FACTOR))
+        .AddAttribute("LazyInterference",
+                      "Whether signals are ignored while sleeping and only buffered while "
+                      "transmitting, instead of always creating interference events. The "
+                      "channel records the signals on air for the LoRaPHY to pick up those "
+                      "which started while it was asleep on waking up",
+                      BooleanValue(false),
+                      MakeBooleanAccessor(&LoRaPHY::SetLazyInterference, &LoRaPHY::IsLazyInterferenceEnabled),
+                      MakeBooleanChecker())
         .AddTraceSource("StartSending",
                         "Trace source indicating the PHY layer"
                         "has begun the sending process for a packet",
@@ -84,6 +165,7 @@ LoRaPHY::GetTypeId(void)
 LoRaPHY::LoRaPHY()
 {
     m_state = STANDBY;
+    m_lazyInterference = false;
     
     m_tx_headerDisabled = false;
     m_tx_codingRate = 1;
@@ -91,6 +173,7 @@ LoRaPHY::LoRaPHY()
     m_tx_numPreambles = 8;
     m_crcEnabled = true;
     m_lowDataRateOpt = false;
+    m_autoLowDataRateOpt = true;
     
     m_tx_sf = 7;
     m_rx_sf = 7;
@@ -98,6 +181,9 @@ LoRaPHY::LoRaPHY()
     m_rx_sens_dBm = -124;
     m_rx_freq_MHz = 868.1;
     m_tx_freq_MHz = 868.1;
+    m_lastRxPower_dBm = std::numeric_limits<double>::quiet_NaN();
+    
+    UpdateOnAirTimeCache();
 }
 
 LoRaPHY::~LoRaPHY()
@@ -121,6 +207,13 @@ void
 LoRaPHY::SetChannel(Ptr<LoRaChannel> c)
 {
     m_channel = c;
+    
+    /*  share the channel's collision matrix instead of keeping a copy  */
+    if (c)
+    {
+        m_interference.SetCollisionSnir (c->GetCollisionSnir ());
+    }
+    
     return;
 }
 
@@ -157,10 +250,12 @@ LoRaPHY::GetMobility(void) const
     {
         return m_mobility;
     }
-    else
+    else if (m_device && m_device->GetNode())
     {
         return m_device->GetNode()->GetObject<MobilityModel>();
     }
+    
+    return Ptr<MobilityModel>();
 }
 
 void 
@@ -180,6 +275,12 @@ void
 LoRaPHY::SetRxSens(double sens_dBm)
 {
     m_rx_sens_dBm = sens_dBm;
+    
+    if (m_channel)
+    {
+        m_channel->NotifyRxSensChanged(sens_dBm);
+    }
+    
     return;
 }
 
@@ -189,6 +290,12 @@ LoRaPHY::GetRxSens(void) const
     return m_rx_sens_dBm;
 }
 
+double
+LoRaPHY::GetLastRxPower(void) const
+{
+    return m_lastRxPower_dBm;
+}
+
 void
 LoRaPHY::SetTxFreq(double freq_MHz)
 {
@@ -205,10 +312,37 @@ LoRaPHY::GetTxFreq(void) const
 void
 LoRaPHY::SetRxFreq(double freq_MHz)
 {
+    double old_freq_MHz = m_rx_freq_MHz;
+    
     m_rx_freq_MHz = freq_MHz;
+    
+    if (m_channel && old_freq_MHz != freq_MHz)
+    {
+        m_channel->NotifyRxFreqChanged(this, freq_MHz);
+    }
+    
     return;
 }
 
+void
+LoRaPHY::SetLazyInterference(bool lazy)
+{
+    m_lazyInterference = lazy;
+    
+    if (m_channel && lazy)
+    {
+        m_channel->NotifyLazyInterference();
+    }
+    
+    return;
+}
+
+bool
+LoRaPHY::IsLazyInterferenceEnabled(void) const
+{
+    return m_lazyInterference;
+}
+
 double
 LoRaPHY::GetRxFreq(void) const
 {
@@ -221,6 +355,7 @@ LoRaPHY::SetTxSF(uint8_t sf)
     if (sf >= MINIMUM_LORA_SPREADING_FACTOR && sf <= MAXIMUM_LORA_SPREADING_FACTOR)
     {
         m_tx_sf = sf;
+        UpdateOnAirTimeCache();
     }
 
     return;
@@ -266,7 +401,23 @@ LoRaPHY::SwitchStateRX(void)
 void
 LoRaPHY::SwitchStateSTANDBY(void)
 {
+    PHYState previous = m_state;
+    
     m_state = STANDBY;
+    
+    if (m_lazyInterference)
+    {
+        if (previous == TX)
+        {
+            FlushPendingSignals();
+        }
+        else if (previous == SLEEP && m_channel)
+        {
+            /*  pick up the signals which started while asleep  */
+            m_channel->ReplayOnAirSignals(this, m_rx_freq_MHz, false);
+        }
+    }
+    
     return;
 }
 
@@ -274,6 +425,29 @@ void
 LoRaPHY::SwitchStateSLEEP(void)
 {
     m_state = SLEEP;
+    
+    /*  nothing heard while transmitting matters to a sleeping radio    */
+    m_pendingSignals.clear();
+    
+    return;
+}
+
+void
+LoRaPHY::FlushPendingSignals(void)
+{
+    std::vector<PendingSignal>::iterator it = m_pendingSignals.begin();
+    Time now = Simulator::Now();
+    
+    for (;it != m_pendingSignals.end();++it)
+    {
+        if (it->start + it->duration > now)
+        {
+            m_interference.Add(it->start, it->duration, it->rx_power_dBm, it->sf, it->packet, it->freq_MHz);
+        }
+    }
+    
+    m_pendingSignals.clear();
+    
     return;
 }
 
@@ -287,6 +461,7 @@ void
 LoRaPHY::SetTxBW(double bw_Hz)
 {
     m_tx_bandwidth_Hz = bw_Hz;
+    UpdateOnAirTimeCache();
     return;
 }
 
@@ -300,6 +475,7 @@ void
 LoRaPHY::SetTxPreamples(uint32_t num_preamples)
 {
     m_tx_numPreambles = num_preamples;
+    UpdateOnAirTimeCache();
     return;
 }
 
@@ -313,6 +489,7 @@ void
 LoRaPHY::SetTxCodingRate(uint8_t coding_rate)
 {
     m_tx_codingRate = coding_rate;
+    UpdateOnAirTimeCache();
     return;
 }
 
@@ -326,19 +503,37 @@ void
 LoRaPHY::ToggleHeader(void)
 {
     m_tx_headerDisabled = !m_tx_headerDisabled;
+    UpdateOnAirTimeCache();
+    return;
+}
+
+void
+LoRaPHY::SetHeaderDisabled(bool disabled)
+{
+    m_tx_headerDisabled = disabled;
+    UpdateOnAirTimeCache();
     return;
 }
 
 bool
 LoRaPHY::IsHeaderDisabled(void) const
 {
-    return m_tx_headerDisabled;
+    return m_onAirConfig.header_disabled;
 }
 
 void
 LoRaPHY::ToggleCRC(void)
 {
     m_crcEnabled = !m_crcEnabled;
+    UpdateOnAirTimeCache();
+    return;
+}
+
+void
+LoRaPHY::SetCRCEnabled(bool enabled)
+{
+    m_crcEnabled = enabled;
+    UpdateOnAirTimeCache();
     return;
 }
 
@@ -351,14 +546,47 @@ LoRaPHY::IsCRCEnabled(void) const
 void
 LoRaPHY::ToggleLowDataRateOpt(void)
 {
+    if (m_autoLowDataRateOpt)
+    {
+        NS_LOG_WARN("Low data rate optimization is chosen automatically, toggling it has no effect until AutoLowDataRateOpt is disabled");
+    }
+    
     m_lowDataRateOpt = !m_lowDataRateOpt;
+    UpdateOnAirTimeCache();
+    return;
+}
+
+void
+LoRaPHY::SetLowDataRateOpt(bool enabled)
+{
+    if (m_autoLowDataRateOpt && enabled != m_lowDataRateOpt)
+    {
+        NS_LOG_WARN("Low data rate optimization is chosen automatically, setting it has no effect until AutoLowDataRateOpt is disabled");
+    }
+    
+    m_lowDataRateOpt = enabled;
+    UpdateOnAirTimeCache();
     return;
 }
 
 bool 
 LoRaPHY::IsLowDataRateOptEnabled(void) const
 {
-    return m_lowDataRateOpt;
+    return m_onAirConfig.low_dr_opt;
+}
+
+void
+LoRaPHY::SetAutoLowDataRateOpt(bool enabled)
+{
+    m_autoLowDataRateOpt = enabled;
+    UpdateOnAirTimeCache();
+    return;
+}
+
+bool
+LoRaPHY::IsAutoLowDataRateOptEnabled(void) const
+{
+    return m_autoLowDataRateOpt;
 }
 
 void
@@ -386,19 +614,76 @@ LoRaPHY::Send(Ptr<Packet> packet)
 Time
 LoRaPHY::GetOnAirTime (Ptr<Packet> packet)
 {
-    double Ts = pow(2, m_tx_sf) / m_tx_bandwidth_Hz;    /*  in seconds  */
-    double Tpreamble = (m_tx_numPreambles + 4.25) * Ts;
     uint32_t pl = packet->GetSize ();
     
-    double de = m_lowDataRateOpt ? 1 : 0;
-    double h = m_tx_headerDisabled? 1 : 0;
-    double crc = m_crcEnabled? 1 : 0;
+    if (!m_onAirTimes)
+    {
+        /*  warn here rather than while the attributes are applied one by one   */
+        if (m_onAirConfig.header_disabled != m_tx_headerDisabled)
+        {
+            NS_LOG_WARN("SF" << (uint32_t)m_tx_sf << " requires the header to be disabled, using implicit header mode");
+        }
+        
+        /*  LoRaPHYs with the same transmit parameters share a table   */
+        m_onAirTimes = &GetOnAirTimeTables()[m_onAirConfig];
+        
+        if (m_onAirTimes->empty())
+        {
+            m_onAirTimes->assign(ON_AIR_TIME_TABLE_SIZE, Time(0));
+        }
+    }
     
-    double payloadSymNb = 8 + std::max((std::ceil((8*pl - 4*m_tx_sf + 28 + 16*crc - 20*h) / (4*(m_tx_sf - 2*de)))) * (m_tx_codingRate + 4), (double)0.0);
+    if (pl < ON_AIR_TIME_TABLE_SIZE && !(*m_onAirTimes)[pl].IsZero ())
+    {
+        return (*m_onAirTimes)[pl];
+    }
     
-    double Tpayload = payloadSymNb * Ts;
+    double payloadSymNb = GetPayloadSymbols(pl, m_tx_sf, m_tx_codingRate, m_onAirConfig.header_disabled, m_crcEnabled, m_onAirConfig.low_dr_opt);
     
-    return Seconds(Tpayload + Tpreamble);
+    double Tpayload = payloadSymNb * m_symbolTime_s;
+    Time dur = Seconds(Tpayload + m_preambleTime_s);
+    
+    if (pl < ON_AIR_TIME_TABLE_SIZE)
+    {
+        (*m_onAirTimes)[pl] = dur;
+    }
+    
+    return dur;
+}
+
+std::map<LoRaPHY::OnAirTimeConfig, std::vector<Time>> &
+LoRaPHY::GetOnAirTimeTables (void)
+{
+    static std::map<OnAirTimeConfig, std::vector<Time>> tables;
+    return tables;
+}
+
+void
+LoRaPHY::UpdateOnAirTimeCache (void)
+{
+    m_symbolTime_s = GetSymbolTime(m_tx_sf, m_tx_bandwidth_Hz);    /*  in seconds  */
+    m_preambleTime_s = (m_tx_numPreambles + 4.25) * m_symbolTime_s;
+    
+    OnAirTimeConfig config = {m_tx_sf, m_tx_bandwidth_Hz, m_tx_numPreambles, m_tx_codingRate, 
+                              m_tx_headerDisabled, m_crcEnabled, m_lowDataRateOpt};
+    
+    /*  SF6 only works in implicit header mode  */
+    if (m_tx_sf == MINIMUM_LORA_SPREADING_FACTOR && !m_tx_headerDisabled)
+    {
+        config.header_disabled = true;
+    }
+    
+    if (m_autoLowDataRateOpt)
+    {
+        config.low_dr_opt = (m_symbolTime_s > LOW_DATA_RATE_OPT_SYMBOL_TIME);
+    }
+    
+    m_onAirConfig = config;
+    
+    /*  the table is looked up on the next on-air time computation  */
+    m_onAirTimes = 0;
+    
+    return;
 }
 
 void
@@ -406,6 +691,18 @@ LoRaPHY::StartReceive(Ptr<Packet> packet, Time duration, uint8_t sf, double rx_p
 {
     NS_LOG_FUNCTION(this << packet);
     
+    if (m_lazyInterference && m_state == SLEEP)
+    {
+        return;     /*  replayed from the channel on waking up, if still on air */
+    }
+    
+    if (m_lazyInterference && m_state == TX)
+    {
+        PendingSignal signal = {packet, Simulator::Now(), duration, sf, rx_power_dBm, freq_MHz};
+        m_pendingSignals.push_back(signal);
+        return;
+    }
+    
     Ptr<LoraInterferenceHelper::Event> event;
     
     event = m_interference.Add(duration, rx_power_dBm, sf, packet, freq_MHz);
@@ -442,6 +739,28 @@ LoRaPHY::StartReceive(Ptr<Packet> packet, Time duration, uint8_t sf, double rx_p
     return;
 }
 
+void
+LoRaPHY::AddInterferer(Ptr<Packet> packet, Time start, Time duration, uint8_t sf, double rx_power_dBm, double freq_MHz)
+{
+    NS_LOG_FUNCTION(this << packet);
+    
+    if (m_lazyInterference && m_state == SLEEP)
+    {
+        return;
+    }
+    
+    if (m_lazyInterference && m_state == TX)
+    {
+        PendingSignal signal = {packet, start, duration, sf, rx_power_dBm, freq_MHz};
+        m_pendingSignals.push_back(signal);
+        return;
+    }
+    
+    m_interference.Add(start, duration, rx_power_dBm, sf, packet, freq_MHz);
+    
+    return;
+}
+
 void
 LoRaPHY::EndReceive (Ptr<Packet> packet, Ptr<LoraInterferenceHelper::Event> event)
 {
@@ -459,6 +778,7 @@ LoRaPHY::EndReceive (Ptr<Packet> packet, Ptr<LoraInterferenceHelper::Event> even
     }
     else
     {
+        m_lastRxPower_dBm = event->GetRxPowerdBm();
         m_rxSniffer(packet);
         m_mac->Receive(packet);
     }
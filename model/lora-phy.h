@@ -35,8 +35,14 @@
 #include "ns3/lora-mac.h"
 #include "ns3/lora-interference-helper.h"
 
+#include <map>
+#include <tuple>
+#include <vector>
+
 #define MINIMUM_LORA_SPREADING_FACTOR   6
 #define MAXIMUM_LORA_SPREADING_FACTOR   12
+#define LOW_DATA_RATE_OPT_SYMBOL_TIME   0.016   /*  symbol time (s) above which auto low data rate optimization is used   */
+#define ON_AIR_TIME_TABLE_SIZE          256     /*  payload sizes (bytes) whose on-air time is cached  */
 
 namespace ns3 {
 namespace lora_mesh {
@@ -216,7 +222,16 @@ public:
     void ToggleHeader(void);
     
     /**
-     *  Checks whether the PHY layer header is disabled or not
+     *  Sets whether the header is disabled or not
+     * 
+     *  \param  disabled    true to disable the header, false to enable it
+     */
+    void SetHeaderDisabled(bool disabled);
+    
+    /**
+     *  Checks whether the PHY layer header is disabled or not. The header is always disabled
+     *  (implicit header mode) at spreading factor 6, as the radio does not support an explicit 
+     *  header there.
      * 
      *  \return true if the header is disabled, false otherwise
      */
@@ -227,6 +242,13 @@ public:
      */
     void ToggleCRC(void);
     
+    /**
+     *  Sets whether CRC is enabled or not
+     * 
+     *  \param  enabled true to enable CRC, false to disable it
+     */
+    void SetCRCEnabled(bool enabled);
+    
     /**
      *  Checks whether CRC is enabled or not
      * 
@@ -235,17 +257,43 @@ public:
     bool IsCRCEnabled(void) const;
     
     /**
-     *  Toggles whether low data rate optimization is enabled or disabled
+     *  Toggles whether low data rate optimization is enabled or disabled, used when automatic low
+     *  data rate optimization is disabled and ignored with a warning otherwise
      */
     void ToggleLowDataRateOpt(void);
     
     /**
-     *  Checks whether low data rate optimization is enaled or not
+     *  Sets whether low data rate optimization is enabled or not, used when automatic low data
+     *  rate optimization is disabled and ignored with a warning otherwise
+     * 
+     *  \param  enabled true to enable low data rate optimization, false to disable it
+     */
+    void SetLowDataRateOpt(bool enabled);
+    
+    /**
+     *  Checks whether low data rate optimization is enaled or not, which is the value chosen
+     *  automatically if automatic low data rate optimization is enabled
      * 
      *  \return true if low data rate optimization is enabled, false otherwise
      */
     bool IsLowDataRateOptEnabled(void) const;
     
+    /**
+     *  Sets whether low data rate optimization is chosen automatically, enabling it whenever the
+     *  symbol time exceeds 16ms (e.g., SF11 and SF12 at 125kHz) as the radio requires
+     * 
+     *  \param  enabled true to choose low data rate optimization automatically, false to use the
+     *                  value set by SetLowDataRateOpt
+     */
+    void SetAutoLowDataRateOpt(bool enabled);
+    
+    /**
+     *  Checks whether low data rate optimization is chosen automatically or not
+     * 
+     *  \return true if low data rate optimization is chosen automatically, false otherwise
+     */
+    bool IsAutoLowDataRateOptEnabled(void) const;
+    
     /**
      *  Sets the receiver sensitivity
      *
@@ -260,6 +308,13 @@ public:
      */
     double GetRxSens(void) const;
     
+    /**
+     *  Gets the power of the signal of the last packet passed up to the LoRaMAC
+     * 
+     *  \return the power (dBm) of the last packet received, NaN if none was received yet
+     */
+    double GetLastRxPower(void) const;
+    
     /**
      *  Sets the frequency the receiver listens for
      * 
@@ -274,6 +329,20 @@ public:
      */
     double GetRxFreq(void) const;
     
+    /**
+     *  Sets whether signals are ignored while asleep and only buffered while transmitting. The
+     *  channel then records the signals on air so that those which started while asleep are 
+     *  registered as interference on waking up.
+     * 
+     *  \param  lazy    true to ignore signals while asleep, false to always register them
+     */
+    void SetLazyInterference(bool lazy);
+    
+    /**
+     *  \return true if signals are ignored while asleep, false otherwise
+     */
+    bool IsLazyInterferenceEnabled(void) const;
+    
     /**
      *  Sets the spreading factor being liistened for
      * 
@@ -324,6 +393,19 @@ public:
      */
     void StartReceive(Ptr<Packet> packet, Time duration, uint8_t sf, double rx_power_dBm, double freq_MHz);
     
+    /**
+     *  Registers a signal which was already arriving at this LoRaPHY before it started listening
+     *  on the signal's frequency, so that it is accounted for as interference only
+     * 
+     *  \param  packet          pointer to the packet carried by the signal
+     *  \param  start           time the signal started arriving at this LoRaPHY
+     *  \param  duration        time for the packet to be received from start to end
+     *  \param  sf              the spreading factor used for the transmission of the packet
+     *  \param  rx_power_dBm    the power (dBm) of the packet's signal at the receiver
+     *  \param  freq_MHz        the frequency (MHz) the packet was transmitted on
+     */
+    void AddInterferer(Ptr<Packet> packet, Time start, Time duration, uint8_t sf, double rx_power_dBm, double freq_MHz);
+    
     /**
      *  Ends the process of receiving a packet
      * 
@@ -340,7 +422,53 @@ public:
      */
     Time GetOnAirTime(Ptr<Packet> packet);
     
+    /**
+     *  Computes the on-air time of a LoRa packet without a LoRaPHY, usable in constant 
+     *  expressions
+     * 
+     *  \param  payload_bytes   size (bytes) of the packet
+     *  \param  sf              the spreading factor used for transmission
+     *  \param  bw_Hz           the bandwidth (Hz) used for transmission
+     *  \param  num_preambles   the number of preambles sent before the packet
+     *  \param  coding_rate     the coding rate used for transmission
+     *  \param  header_disabled whether the header is disabled
+     *  \param  crc_enabled     whether CRC is enabled
+     *  \param  low_dr_opt      whether low data rate optimization is enabled
+     * 
+     *  \return the on-air time (s) of the packet
+     */
+    static constexpr double CalculateOnAirTime(uint32_t payload_bytes, uint8_t sf, double bw_Hz, uint32_t num_preambles, 
+                                               uint8_t coding_rate, bool header_disabled, bool crc_enabled, bool low_dr_opt)
+    {
+        return GetPayloadSymbols(payload_bytes, sf, coding_rate, header_disabled, crc_enabled, low_dr_opt) * GetSymbolTime(sf, bw_Hz)
+            + (num_preambles + 4.25) * GetSymbolTime(sf, bw_Hz);
+    }
+    
 private:
+    /*  constexpr forms of the std::pow, std::ceil and std::max calls of the on-air time formula   */
+    static constexpr double GetSymbolTime(uint8_t sf, double bw_Hz)
+    {
+        return (double)(1u << sf) / bw_Hz;
+    }
+    
+    static constexpr double Ceil(double x)
+    {
+        return ((double)(int64_t)x < x) ? (double)(int64_t)x + 1 : (double)(int64_t)x;
+    }
+    
+    static constexpr double GetPayloadSymbols(uint32_t pl, uint8_t sf, uint8_t cr, bool h, bool crc, bool de)
+    {
+        return 8 + ((Ceil((8.0*pl - 4.0*sf + 28 + 16.0*crc - 20.0*h) / (4.0*(sf - 2.0*de))) * (cr + 4) > 0) ?
+                    Ceil((8.0*pl - 4.0*sf + 28 + 16.0*crc - 20.0*h) / (4.0*(sf - 2.0*de))) * (cr + 4) : 0.0);
+    }
+    
+    /**
+     *  Resolves the header and low data rate optimization actually used, recomputes the cached
+     *  symbol and preamble times and selects the on-air time table for the transmit parameters,
+     *  called whenever a parameter affecting the on-air time changes
+     */
+    void UpdateOnAirTimeCache(void);
+    
     /**
      *  Switches the state of the LoRaPHY to TX
      */
@@ -351,6 +479,12 @@ private:
      */
     void SwitchStateRX(void);
     
+    /**
+     *  Turns the signals buffered while transmitting into interference events, dropping the ones
+     *  which already ended
+     */
+    void FlushPendingSignals(void);
+    
     PHYState            m_state;
     Ptr<LoRaNetDevice>  m_device;
     Ptr<LoRaChannel>    m_channel;
@@ -360,6 +494,22 @@ private:
     
     LoraInterferenceHelper m_interference;
     
+    /*  whether signals are ignored while asleep and only buffered while transmitting   */
+    bool m_lazyInterference;
+    
+    /*  a signal which arrived while transmitting, kept until it can disturb a reception   */
+    struct PendingSignal
+    {
+        Ptr<Packet> packet;
+        Time        start;
+        Time        duration;
+        uint8_t     sf;
+        double      rx_power_dBm;
+        double      freq_MHz;
+    };
+    
+    std::vector<PendingSignal> m_pendingSignals;
+    
     /*  transmit parameters */
     double      m_tx_power_dBm;
     double      m_tx_freq_MHz;
@@ -371,10 +521,47 @@ private:
     bool        m_crcEnabled;
     bool        m_lowDataRateOpt;
     
+    /*  transmit parameters which determine the on-air time of a packet  */
+    struct OnAirTimeConfig
+    {
+        uint8_t     sf;
+        double      bw_Hz;
+        uint32_t    num_preambles;
+        uint8_t     coding_rate;
+        bool        header_disabled;
+        bool        crc_enabled;
+        bool        low_dr_opt;
+        
+        bool operator< (const OnAirTimeConfig &other) const
+        {
+            return std::tie(sf, bw_Hz, num_preambles, coding_rate, header_disabled, crc_enabled, low_dr_opt) <
+                std::tie(other.sf, other.bw_Hz, other.num_preambles, other.coding_rate, other.header_disabled, other.crc_enabled, other.low_dr_opt);
+        }
+    };
+    
+    /**
+     *  \return the on-air times shared by all LoRaPHYs, indexed by transmit parameters and then by
+     *  payload size (zero where not computed yet)
+     */
+    static std::map<OnAirTimeConfig, std::vector<Time>> &GetOnAirTimeTables(void);
+    
+    /*  whether low data rate optimization follows the symbol time   */
+    bool m_autoLowDataRateOpt;
+    
+    /*  transmit parameters in effect, after the SF6 and automatic low data rate optimization rules */
+    OnAirTimeConfig     m_onAirConfig;
+    
+    /*  cached symbol and preamble times (s) and on-air time table for the transmit parameters 
+        (null until the next on-air time is computed)   */
+    double              m_symbolTime_s;
+    double              m_preambleTime_s;
+    std::vector<Time>   *m_onAirTimes;
+    
     /*  receiver parameters   */
     double  m_rx_sens_dBm;
     double  m_rx_freq_MHz;
     uint8_t m_rx_sf;
+    double  m_lastRxPower_dBm;
     
     TracedCallback<Ptr<const Packet>, uint32_t> m_startSending;
     TracedCallback<Ptr<const Packet>>           m_phyRxBeginTrace;
@@ -13,6 +13,7 @@
 #include "ns3/application.h"
 
 #include <iterator>
+#include <vector>
 
 using namespace ns3;
 using namespace lora_mesh;
@@ -690,6 +691,262 @@ LoRaMeshTestCase1_13::DoRun(void)
     return;
 }
 /************************************************************************************/
+/*  Test Case #1.14: Interference Event Pool Reuse   */
+class LoRaMeshTestCase1_14 : public TestCase
+{
+public:
+    LoRaMeshTestCase1_14();
+    virtual ~LoRaMeshTestCase1_14();
+
+private:
+    virtual void DoRun(void);
+};
+
+LoRaMeshTestCase1_14::LoRaMeshTestCase1_14()
+  : TestCase("LoRa Mesh Test Case #1.14: Interference Event Pool Reuse")
+{
+}
+
+LoRaMeshTestCase1_14::~LoRaMeshTestCase1_14()
+{
+}
+
+void
+LoRaMeshTestCase1_14::DoRun(void)
+{
+    Ptr<Packet> packet = Create<Packet>(25);
+    std::vector<Ptr<LoraInterferenceHelper::Event>> events;
+    uint32_t live = LoraInterferenceHelper::Event::GetNLiveEvents();
+    
+    for (int i = 0; i < 1000; i++)
+    {
+        events.push_back(Create<LoraInterferenceHelper::Event>(Seconds(1), -100, 7, packet, 868.1));
+    }
+    
+    NS_TEST_ASSERT_MSG_EQ(LoraInterferenceHelper::Event::GetNLiveEvents(), live + 1000, "Test Case #1.14: Live Events Not Counted");
+    
+    events.clear();
+    uint32_t capacity = LoraInterferenceHelper::Event::GetPoolCapacity();
+    
+    NS_TEST_ASSERT_MSG_EQ(LoraInterferenceHelper::Event::GetNLiveEvents(), live, "Test Case #1.14: Events Not Returned to Pool");
+    
+    /*  the same number of events again must not grow the pool  */
+    for (int i = 0; i < 1000; i++)
+    {
+        events.push_back(Create<LoraInterferenceHelper::Event>(Seconds(1), -100, 7, packet, 868.1));
+    }
+    
+    events.clear();
+    
+    NS_TEST_ASSERT_MSG_EQ(LoraInterferenceHelper::Event::GetPoolCapacity(), capacity, "Test Case #1.14: Event Pool Grew on Reuse");
+    
+    return;
+}
+/************************************************************************************/
+/*  Test Case #1.15: Sleeping PHY Ignores Signals   */
+class LoRaMeshTestCase1_15 : public TestCase
+{
+public:
+    LoRaMeshTestCase1_15();
+    virtual ~LoRaMeshTestCase1_15();
+
+private:
+    virtual void DoRun(void);
+};
+
+LoRaMeshTestCase1_15::LoRaMeshTestCase1_15()
+  : TestCase("LoRa Mesh Test Case #1.15: Sleeping PHY Ignores Signals")
+{
+}
+
+LoRaMeshTestCase1_15::~LoRaMeshTestCase1_15()
+{
+}
+
+void
+LoRaMeshTestCase1_15::DoRun(void)
+{
+    Ptr<LoRaPHY> phy = CreateObject<LoRaPHY>();
+    Ptr<Packet> packet = Create<Packet>(25);
+    uint32_t live = LoraInterferenceHelper::Event::GetNLiveEvents();
+    
+    phy->SetAttribute("LazyInterference", BooleanValue(true));
+    phy->SwitchStateSLEEP();
+    phy->StartReceive(packet, Seconds(1), 7, -100, 868.1);
+    
+    NS_TEST_ASSERT_MSG_EQ(LoraInterferenceHelper::Event::GetNLiveEvents(), live, "Test Case #1.15: Sleeping PHY Created Interference Event");
+    
+    /*  without the attribute every signal is kept as interference  */
+    phy->SetAttribute("LazyInterference", BooleanValue(false));
+    phy->StartReceive(packet, Seconds(1), 7, -100, 868.1);
+    
+    NS_TEST_ASSERT_MSG_EQ(LoraInterferenceHelper::Event::GetNLiveEvents(), live + 1, "Test Case #1.15: Signal Not Kept as Interference");
+    
+    return;
+}
+/************************************************************************************/
+/*  Test Case #1.16: Configuring PHYs and MACs Through Attributes   */
+class LoRaMeshTestCase1_16 : public TestCase
+{
+public:
+    LoRaMeshTestCase1_16();
+    virtual ~LoRaMeshTestCase1_16();
+
+private:
+    virtual void DoRun(void);
+};
+
+LoRaMeshTestCase1_16::LoRaMeshTestCase1_16()
+  : TestCase("LoRa Mesh Test Case #1.16: Configuring PHYs and MACs Through Attributes")
+{
+}
+
+LoRaMeshTestCase1_16::~LoRaMeshTestCase1_16()
+{
+}
+
+void
+LoRaMeshTestCase1_16::DoRun(void)
+{
+    Ptr<LoRaPHY> phy = CreateObject<LoRaPHY>();
+    
+    NS_TEST_ASSERT_MSG_EQ(phy->GetTxSF(), 7, "Test Case #1.16: Failed Default Spreading Factor");
+    NS_TEST_ASSERT_MSG_EQ(phy->IsCRCEnabled(), true, "Test Case #1.16: Failed Default CRC");
+    
+    Config::SetDefault("ns3::LoRaPHY::TxSF", UintegerValue(10));
+    Config::SetDefault("ns3::LoRaPHY::LowDataRateOpt", BooleanValue(true));
+    Config::SetDefault("ns3::LoRaPHY::AutoLowDataRateOpt", BooleanValue(false));
+    Config::SetDefault("ns3::LoRaMAC::MaxDelay", UintegerValue(20));
+    
+    phy = CreateObject<LoRaPHY>();
+    Ptr<LoRaMAC> mac = CreateObject<LoRaMAC>();
+    
+    Config::SetDefault("ns3::LoRaPHY::TxSF", UintegerValue(7));
+    Config::SetDefault("ns3::LoRaPHY::LowDataRateOpt", BooleanValue(false));
+    Config::SetDefault("ns3::LoRaPHY::AutoLowDataRateOpt", BooleanValue(true));
+    Config::SetDefault("ns3::LoRaMAC::MaxDelay", UintegerValue(60));
+    
+    NS_TEST_ASSERT_MSG_EQ(phy->GetTxSF(), 10, "Test Case #1.16: Failed to Set Default Spreading Factor");
+    NS_TEST_ASSERT_MSG_EQ(phy->IsLowDataRateOptEnabled(), true, "Test Case #1.16: Failed to Set Default Low Data Rate Optimization");
+    NS_TEST_ASSERT_MSG_EQ(mac->GetMaxDelay(), 20, "Test Case #1.16: Failed to Set Default Maximum Delay");
+    
+    phy->SetAttribute("RxSens", DoubleValue(-130));
+    phy->SetAttribute("HeaderDisabled", BooleanValue(true));
+    
+    NS_TEST_ASSERT_MSG_EQ(phy->GetRxSens(), -130, "Test Case #1.16: Failed to Set Sensitivity");
+    NS_TEST_ASSERT_MSG_EQ(phy->IsHeaderDisabled(), true, "Test Case #1.16: Failed to Disable Header");
+    
+    return;
+}
+/************************************************************************************/
+/*  Test Case #1.17: Computing On-Air Times   */
+class LoRaMeshTestCase1_17 : public TestCase
+{
+public:
+    LoRaMeshTestCase1_17();
+    virtual ~LoRaMeshTestCase1_17();
+
+private:
+    virtual void DoRun(void);
+};
+
+LoRaMeshTestCase1_17::LoRaMeshTestCase1_17()
+  : TestCase("LoRa Mesh Test Case #1.17: Computing On-Air Times")
+{
+}
+
+LoRaMeshTestCase1_17::~LoRaMeshTestCase1_17()
+{
+}
+
+void
+LoRaMeshTestCase1_17::DoRun(void)
+{
+    /*  SF7, 125kHz, 8 preambles, 4/5, explicit header and CRC: 40.25 symbols of 1.024ms    */
+    static constexpr double airtime = LoRaPHY::CalculateOnAirTime(10, 7, 125000, 8, 1, false, true, false);
+    
+    NS_TEST_ASSERT_MSG_EQ_TOL(airtime, 0.041216, 1e-9, "Test Case #1.17: Incorrect On-Air Time Calculated");
+    
+    Ptr<LoRaPHY> phy = CreateObject<LoRaPHY>();
+    Ptr<LoRaPHY> other = CreateObject<LoRaPHY>();
+    Ptr<Packet> packet = Create<Packet>(10);
+    
+    NS_TEST_ASSERT_MSG_EQ(phy->GetOnAirTime(packet), Seconds(airtime), "Test Case #1.17: Incorrect On-Air Time");
+    NS_TEST_ASSERT_MSG_EQ(phy->GetOnAirTime(packet), Seconds(airtime), "Test Case #1.17: Incorrect Cached On-Air Time");
+    
+    /*  changing the parameters of one LoRaPHY must not affect the other's cached on-air times   */
+    phy->SetTxSF(12);
+    phy->SetLowDataRateOpt(true);
+    
+    NS_TEST_ASSERT_MSG_EQ(phy->GetOnAirTime(packet), Seconds(LoRaPHY::CalculateOnAirTime(10, 12, 125000, 8, 1, false, true, true)),
+                          "Test Case #1.17: On-Air Time Not Updated");
+    NS_TEST_ASSERT_MSG_EQ(other->GetOnAirTime(packet), Seconds(airtime), "Test Case #1.17: Shared On-Air Time Changed");
+    
+    return;
+}
+/************************************************************************************/
+/*  Test Case #1.18: Automatic Low Data Rate Optimization and SF6 Implicit Header   */
+class LoRaMeshTestCase1_18 : public TestCase
+{
+public:
+    LoRaMeshTestCase1_18();
+    virtual ~LoRaMeshTestCase1_18();
+
+private:
+    virtual void DoRun(void);
+};
+
+LoRaMeshTestCase1_18::LoRaMeshTestCase1_18()
+  : TestCase("LoRa Mesh Test Case #1.18: Automatic Low Data Rate Optimization and SF6 Implicit Header")
+{
+}
+
+LoRaMeshTestCase1_18::~LoRaMeshTestCase1_18()
+{
+}
+
+void
+LoRaMeshTestCase1_18::DoRun(void)
+{
+    Ptr<LoRaPHY> phy = CreateObject<LoRaPHY>();
+    Ptr<Packet> packet = Create<Packet>(50);
+    
+    phy->SetTxSF(10);
+    
+    NS_TEST_ASSERT_MSG_EQ(phy->IsLowDataRateOptEnabled(), false, "Test Case #1.18: Low Data Rate Optimization Enabled at SF10");
+    
+    /*  SF11 at 125kHz has 16.384ms symbols */
+    phy->SetTxSF(11);
+    
+    NS_TEST_ASSERT_MSG_EQ(phy->IsLowDataRateOptEnabled(), true, "Test Case #1.18: Low Data Rate Optimization Not Enabled at SF11");
+    NS_TEST_ASSERT_MSG_EQ(phy->GetOnAirTime(packet), Seconds(LoRaPHY::CalculateOnAirTime(50, 11, 125000, 8, 1, false, true, true)),
+                          "Test Case #1.18: On-Air Time Without Low Data Rate Optimization");
+    
+    /*  SF11 at 250kHz has 8.192ms symbols */
+    phy->SetTxBW(250000);
+    
+    NS_TEST_ASSERT_MSG_EQ(phy->IsLowDataRateOptEnabled(), false, "Test Case #1.18: Low Data Rate Optimization Enabled at 250kHz");
+    
+    /*  an explicit value is ignored while it is chosen automatically  */
+    phy->SetLowDataRateOpt(true);
+    
+    NS_TEST_ASSERT_MSG_EQ(phy->IsLowDataRateOptEnabled(), false, "Test Case #1.18: Explicit Low Data Rate Optimization Used in Automatic Mode");
+    
+    phy->SetLowDataRateOpt(false);
+    phy->SetTxBW(125000);
+    phy->SetAutoLowDataRateOpt(false);
+    
+    NS_TEST_ASSERT_MSG_EQ(phy->IsLowDataRateOptEnabled(), false, "Test Case #1.18: Manual Low Data Rate Optimization Not Used");
+    
+    phy->SetTxSF(6);
+    
+    NS_TEST_ASSERT_MSG_EQ(phy->IsHeaderDisabled(), true, "Test Case #1.18: Explicit Header Used at SF6");
+    NS_TEST_ASSERT_MSG_EQ(phy->GetOnAirTime(packet), Seconds(LoRaPHY::CalculateOnAirTime(50, 6, 125000, 8, 1, true, true, false)),
+                          "Test Case #1.18: On-Air Time With Explicit Header at SF6");
+    
+    return;
+}
+/************************************************************************************/
 
 
 class LoRaMeshTestSuite_1 : public TestSuite
@@ -715,6 +972,11 @@ LoRaMeshTestSuite_1::LoRaMeshTestSuite_1()
     AddTestCase(new LoRaMeshTestCase1_9, TestCase::QUICK);
     AddTestCase(new LoRaMeshTestCase1_10, TestCase::QUICK);
     AddTestCase(new LoRaMeshTestCase1_11, TestCase::QUICK);
+    AddTestCase(new LoRaMeshTestCase1_14, TestCase::QUICK);
+    AddTestCase(new LoRaMeshTestCase1_15, TestCase::QUICK);
+    AddTestCase(new LoRaMeshTestCase1_16, TestCase::QUICK);
+    AddTestCase(new LoRaMeshTestCase1_17, TestCase::QUICK);
+    AddTestCase(new LoRaMeshTestCase1_18, TestCase::QUICK);
     AddTestCase(new LoRaMeshTestCase1_12, TestCase::TAKES_FOREVER);
     AddTestCase(new LoRaMeshTestCase1_13, TestCase::TAKES_FOREVER);
 }
@@ -6,13 +6,21 @@
 #include "ns3/core-module.h"
 #include "ns3/test.h"
 #include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
 #include "ns3/vector.h"
 #include "ns3/mobility-helper.h"
 #include "ns3/simulator.h"
 #include "ns3/callback.h"
 #include "ns3/propagation-loss-model.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
 
 #include <iterator>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include <set>
+#include <string>
 
 using namespace ns3;
 using namespace lora_mesh;
@@ -152,6 +160,602 @@ LoRaMeshTestCase2_5::DoRun(void)
     return;
 }
 
+/************************************************************************************/
+/*  Test Case #2.6: Channel Spatial Index Range Bound   */
+class LoRaMeshTestCase2_6 : public TestCase
+{
+public:
+    LoRaMeshTestCase2_6();
+    virtual ~LoRaMeshTestCase2_6();
+
+private:
+    virtual void DoRun(void);
+};
+
+LoRaMeshTestCase2_6::LoRaMeshTestCase2_6()
+  : TestCase("LoRa Mesh Test Case #2.6: Channel Spatial Index Range Bound")
+{
+}
+
+LoRaMeshTestCase2_6::~LoRaMeshTestCase2_6()
+{
+}
+
+void
+LoRaMeshTestCase2_6::DoRun(void)
+{
+    Ptr<LoRaChannel> channel = CreateObject<LoRaChannel>();
+    Ptr<LoRaPHY> phy = CreateObject<LoRaPHY>();
+    
+    Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel>();
+    loss->SetPathLossExponent(4);
+    loss->SetReference(1, 7.7);
+    
+    channel->SetLossModel(loss);
+    
+    NS_TEST_ASSERT_MSG_LT(channel->GetMaxRange(14), 0, "Test Case #2.6: Range Bound Derived without Receivers");
+    
+    phy->SetRxSens(-130);
+    channel->AddPHY(phy);
+    
+    /*  range must be where the received power equals the sensitivity less the margin  */
+    double range = channel->GetMaxRange(14);
+    double rx_power_dBm = 14 - 7.7 - 40 * std::log10(range);
+    
+    NS_TEST_ASSERT_MSG_EQ_TOL(rx_power_dBm, -136, 0.001, "Test Case #2.6: Incorrect Range Bound from Loss Model");
+    
+    /*  a chained model could add gain, so no bound is derived  */
+    Ptr<LogDistancePropagationLossModel> chained = CreateObject<LogDistancePropagationLossModel>();
+    chained->SetNext(CreateObject<LogDistancePropagationLossModel>());
+    channel->SetLossModel(chained);
+    
+    NS_TEST_ASSERT_MSG_LT(channel->GetMaxRange(14), 0, "Test Case #2.6: Range Bound Derived for Loss Chain");
+    
+    channel->SetAttribute("MaxRange", DoubleValue(500));
+    
+    NS_TEST_ASSERT_MSG_EQ(channel->GetMaxRange(14), 500, "Test Case #2.6: Range Bound Ignores MaxRange Attribute");
+    
+    return;
+}
+
+/************************************************************************************/
+/*  Test Case #2.7: Channel Collision Matrix   */
+class LoRaMeshTestCase2_7 : public TestCase
+{
+public:
+    LoRaMeshTestCase2_7();
+    virtual ~LoRaMeshTestCase2_7();
+
+private:
+    virtual void DoRun(void);
+};
+
+LoRaMeshTestCase2_7::LoRaMeshTestCase2_7()
+  : TestCase("LoRa Mesh Test Case #2.7: Channel Collision Matrix")
+{
+}
+
+LoRaMeshTestCase2_7::~LoRaMeshTestCase2_7()
+{
+}
+
+void
+LoRaMeshTestCase2_7::DoRun(void)
+{
+    Ptr<LoRaChannel> channel = CreateObject<LoRaChannel>();
+    
+    /*  linear tables must match the dB tables  */
+    for (int i = 0; i < 7; i++)
+    {
+        for (int j = 0; j < 7; j++)
+        {
+            NS_TEST_ASSERT_MSG_EQ_TOL(LoraInterferenceHelper::collisionSnirGoursaud.linear[i][j],
+                                      std::pow(10, LoraInterferenceHelper::collisionSnirGoursaud.dB[i][j] / 10),
+                                      1e-12, "Test Case #2.7: Goursaud Linear Matrix Mismatch");
+        }
+    }
+    
+    /*  indexed from SF6    */
+    NS_TEST_ASSERT_MSG_EQ(channel->GetCollisionSnir()->dB[1][2], -16, "Test Case #2.7: Goursaud Matrix Not Default");
+    NS_TEST_ASSERT_MSG_EQ(channel->GetCollisionSnir()->dB[0][0], 6, "Test Case #2.7: No SF6 Entries in Goursaud Matrix");
+    
+    channel->SetAttribute("CollisionMatrix", EnumValue(LoraInterferenceHelper::ALOHA));
+    
+    NS_TEST_ASSERT_MSG_EQ(channel->GetCollisionSnir()->linear[0][1], 0, "Test Case #2.7: Failed to Select Aloha Matrix");
+    
+    std::vector<std::vector<double>> custom (6, std::vector<double>(6, -10));
+    channel->SetCustomCollisionMatrix(custom);
+    
+    NS_TEST_ASSERT_MSG_EQ(channel->GetCollisionMatrix(), LoraInterferenceHelper::CUSTOM, "Test Case #2.7: Custom Matrix Not Selected");
+    NS_TEST_ASSERT_MSG_EQ_TOL(channel->GetCollisionSnir()->linear[3][4], 0.1, 1e-12, "Test Case #2.7: Incorrect Custom Linear Matrix");
+    NS_TEST_ASSERT_MSG_EQ(channel->GetCollisionSnir()->dB[0][1], -16, "Test Case #2.7: SF6 Entries Not Kept for 6x6 Custom Matrix");
+    
+    return;
+}
+
+/************************************************************************************/
+/*  Test Case #2.8: Installing Devices in Bulk   */
+class LoRaMeshTestCase2_8 : public TestCase
+{
+public:
+    LoRaMeshTestCase2_8();
+    virtual ~LoRaMeshTestCase2_8();
+
+private:
+    virtual void DoRun(void);
+};
+
+LoRaMeshTestCase2_8::LoRaMeshTestCase2_8()
+  : TestCase("LoRa Mesh Test Case #2.8: Installing Devices in Bulk")
+{
+}
+
+LoRaMeshTestCase2_8::~LoRaMeshTestCase2_8()
+{
+}
+
+void
+LoRaMeshTestCase2_8::DoRun(void)
+{
+    Ptr<LoRaChannel> channel = CreateObject<LoRaChannel>();
+    NodeContainer nodes;
+    NodeContainer reversed;
+    LoRaPhyHelper phy;
+    LoRaMacHelper mac;
+    LoRaMeshHelper helper;
+    NetDeviceContainer devices;
+    
+    nodes.Create(10);
+    
+    for (int i = 9;i >= 0;i--)
+    {
+        if (i != 4)
+        {
+            reversed.Add(nodes.Get(i));
+        }
+    }
+    
+    phy.SetChannel(channel);
+    
+    /*  a single device first, then the rest in reverse node order   */
+    helper.Install(phy, mac, nodes.Get(4));
+    devices = helper.Install(phy, mac, reversed);
+    
+    NS_TEST_ASSERT_MSG_EQ(devices.GetN(), 9, "Test Case #2.8: Incorrect Number of Devices Installed");
+    NS_TEST_ASSERT_MSG_EQ(channel->GetNDevices(), 10, "Test Case #2.8: Incorrect Number of PHYs Attached");
+    
+    for (uint32_t i = 0;i < channel->GetNDevices();i++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(channel->GetDevice(i)->GetNode()->GetId(), nodes.Get(i)->GetId(), "Test Case #2.8: PHYs Not Sorted by Node ID");
+    }
+    
+    Ptr<LoRaNetDevice> device = DynamicCast<LoRaNetDevice>(devices.Get(0));
+    
+    NS_TEST_ASSERT_MSG_EQ(device->GetNode(), nodes.Get(9), "Test Case #2.8: Device Installed on Wrong Node");
+    NS_TEST_ASSERT_MSG_EQ(device->GetPHY()->GetChannel(), channel, "Test Case #2.8: PHY Not Using Channel");
+    NS_TEST_ASSERT_MSG_EQ(device->GetMAC()->GetPHY(), device->GetPHY(), "Test Case #2.8: MAC Not Connected to PHY");
+    NS_TEST_ASSERT_MSG_EQ(helper.AssignStreams(devices, 0), 9, "Test Case #2.8: Incorrect Number of Streams Assigned");
+    
+    return;
+}
+
+/************************************************************************************/
+/*  Test Case #2.9: Lazy Interference without Frequency Buckets    */
+class LoRaMeshTestCase2_9 : public TestCase
+{
+public:
+    LoRaMeshTestCase2_9();
+    virtual ~LoRaMeshTestCase2_9();
+
+private:
+    virtual void DoRun(void);
+};
+
+LoRaMeshTestCase2_9::LoRaMeshTestCase2_9()
+  : TestCase("LoRa Mesh Test Case #2.9: Lazy Interference without Frequency Buckets")
+{
+}
+
+LoRaMeshTestCase2_9::~LoRaMeshTestCase2_9()
+{
+}
+
+void
+LoRaMeshTestCase2_9::DoRun(void)
+{
+    Ptr<LoRaChannel> channel = CreateObject<LoRaChannel>();
+    Ptr<LoRaPHY> sender = CreateObject<LoRaPHY>();
+    Ptr<LoRaPHY> receiver = CreateObject<LoRaPHY>();
+    Ptr<MobilityModel> mobility;
+    Ptr<Packet> packet = Create<Packet>(25);
+    
+    channel->SetLossModel(CreateObject<LogDistancePropagationLossModel>());
+    channel->SetDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+    
+    mobility = CreateObject<ConstantPositionMobilityModel>();
+    sender->SetMobility(mobility);
+    mobility = CreateObject<ConstantPositionMobilityModel>();
+    mobility->SetPosition(Vector3D(100, 0, 0));
+    receiver->SetMobility(mobility);
+    
+    receiver->SetAttribute("LazyInterference", BooleanValue(true));
+    
+    sender->SetChannel(channel);
+    receiver->SetChannel(channel);
+    channel->AddPHY(sender);
+    channel->AddPHY(receiver);
+    
+    /*  the signal starts while the receiver sleeps and is still on air when it wakes up   */
+    receiver->SwitchStateSLEEP();
+    channel->Send(sender, packet, 14, 868.1, 7, Seconds(1));
+    
+    uint32_t live = LoraInterferenceHelper::Event::GetNLiveEvents();
+    
+    Simulator::Schedule(MilliSeconds(500), &LoRaPHY::SwitchStateSTANDBY, receiver);
+    Simulator::Stop(MilliSeconds(600));
+    Simulator::Run();
+    
+    NS_TEST_ASSERT_MSG_EQ(LoraInterferenceHelper::Event::GetNLiveEvents(), live + 1, "Test Case #2.9: Signal on Air Not Replayed on Waking Up");
+    
+    Simulator::Destroy();
+    
+    return;
+}
+
+/************************************************************************************/
+/*  Test Case #2.10: Static Topology Stochastic Loss    */
+class LoRaMeshCountingLossModel : public PropagationLossModel
+{
+public:
+    LoRaMeshCountingLossModel() : m_calls(0) {}
+    
+    mutable uint32_t m_calls;
+    
+private:
+    virtual double DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+    {
+        m_calls++;
+        return txPowerDbm - 3;
+    }
+    
+    virtual int64_t DoAssignStreams(int64_t stream)
+    {
+        return 0;
+    }
+};
+
+class LoRaMeshTestCase2_10 : public TestCase
+{
+public:
+    LoRaMeshTestCase2_10();
+    virtual ~LoRaMeshTestCase2_10();
+
+private:
+    virtual void DoRun(void);
+    
+    void SendPackets(bool freeze, Ptr<LoRaMeshCountingLossModel> loss, Ptr<LoRaMeshCountingLossModel> stochastic);
+};
+
+LoRaMeshTestCase2_10::LoRaMeshTestCase2_10()
+  : TestCase("LoRa Mesh Test Case #2.10: Static Topology Stochastic Loss")
+{
+}
+
+LoRaMeshTestCase2_10::~LoRaMeshTestCase2_10()
+{
+}
+
+void
+LoRaMeshTestCase2_10::SendPackets(bool freeze, Ptr<LoRaMeshCountingLossModel> loss, Ptr<LoRaMeshCountingLossModel> stochastic)
+{
+    Ptr<LoRaChannel> channel = CreateObject<LoRaChannel>();
+    Ptr<LoRaPHY> sender = CreateObject<LoRaPHY>();
+    Ptr<LoRaPHY> receiver = CreateObject<LoRaPHY>();
+    Ptr<MobilityModel> mobility;
+    
+    channel->SetAttribute("StaticTopology", BooleanValue(true));
+    channel->SetAttribute("FreezeStochasticLoss", BooleanValue(freeze));
+    channel->SetLossModel(loss);
+    channel->SetStochasticLossModel(stochastic);
+    channel->SetDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+    
+    mobility = CreateObject<ConstantPositionMobilityModel>();
+    sender->SetMobility(mobility);
+    mobility = CreateObject<ConstantPositionMobilityModel>();
+    mobility->SetPosition(Vector3D(100, 0, 0));
+    receiver->SetMobility(mobility);
+    
+    sender->SetChannel(channel);
+    receiver->SetChannel(channel);
+    channel->AddPHY(sender);
+    channel->AddPHY(receiver);
+    
+    for (int i = 0; i < 3; i++)
+    {
+        Simulator::Schedule(Seconds(2 * i), &LoRaChannel::Send, channel, sender, Create<Packet>(25), 14.0, 868.1, uint8_t(7), Seconds(1));
+    }
+    
+    Simulator::Run();
+    Simulator::Destroy();
+    
+    return;
+}
+
+void
+LoRaMeshTestCase2_10::DoRun(void)
+{
+    Ptr<LoRaMeshCountingLossModel> loss = CreateObject<LoRaMeshCountingLossModel>();
+    Ptr<LoRaMeshCountingLossModel> stochastic = CreateObject<LoRaMeshCountingLossModel>();
+    
+    /*  frozen: both models are sampled once for the link  */
+    SendPackets(true, loss, stochastic);
+    
+    NS_TEST_ASSERT_MSG_EQ(loss->m_calls, 1, "Test Case #2.10: Loss Model Not Cached");
+    NS_TEST_ASSERT_MSG_EQ(stochastic->m_calls, 1, "Test Case #2.10: Frozen Stochastic Loss Re-sampled");
+    
+    loss = CreateObject<LoRaMeshCountingLossModel>();
+    stochastic = CreateObject<LoRaMeshCountingLossModel>();
+    
+    /*  re-sampled: only the loss model of the channel is cached  */
+    SendPackets(false, loss, stochastic);
+    
+    NS_TEST_ASSERT_MSG_EQ(loss->m_calls, 1, "Test Case #2.10: Loss Model Not Cached when Re-sampling");
+    NS_TEST_ASSERT_MSG_EQ(stochastic->m_calls, 3, "Test Case #2.10: Stochastic Loss Not Re-sampled for Every Packet");
+    NS_TEST_ASSERT_MSG_EQ(loss->GetNext(), 0, "Test Case #2.10: Loss Chain Modified");
+    
+    return;
+}
+
+/************************************************************************************/
+/*  Test Case #2.11: Frequency Buckets with Retuning    */
+class LoRaMeshTestCase2_11 : public TestCase
+{
+public:
+    LoRaMeshTestCase2_11();
+    virtual ~LoRaMeshTestCase2_11();
+
+private:
+    virtual void DoRun(void);
+    
+    void PacketReceived(Ptr<const Packet> packet);
+    Ptr<Packet> MakePacket(void);
+    
+    std::vector<uint64_t> m_received;
+};
+
+LoRaMeshTestCase2_11::LoRaMeshTestCase2_11()
+  : TestCase("LoRa Mesh Test Case #2.11: Frequency Buckets with Retuning")
+{
+}
+
+LoRaMeshTestCase2_11::~LoRaMeshTestCase2_11()
+{
+}
+
+void
+LoRaMeshTestCase2_11::PacketReceived(Ptr<const Packet> packet)
+{
+    m_received.push_back(packet->GetUid());
+    return;
+}
+
+Ptr<Packet>
+LoRaMeshTestCase2_11::MakePacket(void)
+{
+    /*  addressed elsewhere so the receiving LoRaMAC neither answers nor forwards it    */
+    Ptr<Packet> packet = Create<Packet>(25);
+    LoRaMeshHeader header;
+    header.SetType(DIRECTED);
+    header.SetSrc(98);
+    header.SetFwd(98);
+    header.SetDest(99);
+    packet->AddHeader(header);
+    
+    return packet;
+}
+
+void
+LoRaMeshTestCase2_11::DoRun(void)
+{
+    Ptr<LoRaChannel> channel = CreateObject<LoRaChannel>();
+    Ptr<LoRaPHY> sender = CreateObject<LoRaPHY>();
+    Ptr<LoRaPHY> interferer = CreateObject<LoRaPHY>();
+    Ptr<LoRaPHY> receiver = CreateObject<LoRaPHY>();
+    Ptr<MobilityModel> mobility;
+    
+    channel->SetAttribute("FrequencyBuckets", BooleanValue(true));
+    channel->SetLossModel(CreateObject<LogDistancePropagationLossModel>());
+    channel->SetDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+    
+    /*  both transmitters at the same distance from the receiver  */
+    mobility = CreateObject<ConstantPositionMobilityModel>();
+    mobility->SetPosition(Vector3D(-100, 0, 0));
+    sender->SetMobility(mobility);
+    mobility = CreateObject<ConstantPositionMobilityModel>();
+    mobility->SetPosition(Vector3D(100, 0, 0));
+    interferer->SetMobility(mobility);
+    receiver->SetMobility(CreateObject<ConstantPositionMobilityModel>());
+    
+    /*  the LoRaMAC is only there to take the received packets  */
+    receiver->SetMAC(CreateObject<LoRaMAC>());
+    receiver->SetRxFreq(868.1);
+    receiver->TraceConnectWithoutContext("RxSniffer", MakeCallback(&LoRaMeshTestCase2_11::PacketReceived, this));
+    
+    sender->SetChannel(channel);
+    interferer->SetChannel(channel);
+    receiver->SetChannel(channel);
+    channel->AddPHY(sender);
+    channel->AddPHY(interferer);
+    channel->AddPHY(receiver);
+    
+    /*  retuned while the signal still propagates, so it is received as usual  */
+    Ptr<Packet> propagating = MakePacket();
+    channel->Send(sender, propagating, 14, 868.3, 7, Seconds(1));
+    receiver->SetRxFreq(868.3);
+    
+    /*  retuned half way through a signal, which then only interferes with the next one  */
+    Ptr<Packet> missed = MakePacket();
+    Ptr<Packet> interfered = MakePacket();
+    Simulator::Schedule(Seconds(2), &LoRaChannel::Send, channel, sender, missed, 14.0, 868.5, uint8_t(7), Seconds(1));
+    Simulator::Schedule(Seconds(2.5), &LoRaPHY::SetRxFreq, receiver, 868.5);
+    Simulator::Schedule(Seconds(2.6), &LoRaChannel::Send, channel, interferer, interfered, 14.0, 868.5, uint8_t(7), Seconds(1));
+    
+    Simulator::Stop(Seconds(5));
+    Simulator::Run();
+    Simulator::Destroy();
+    
+    NS_TEST_ASSERT_MSG_EQ(m_received.size(), 1, "Test Case #2.11: Incorrect Number of Packets Received");
+    
+    if (!m_received.empty())
+    {
+        NS_TEST_ASSERT_MSG_EQ(m_received[0], propagating->GetUid(), "Test Case #2.11: Propagating Signal Not Received after Retuning");
+    }
+    
+    NS_TEST_ASSERT_MSG_EQ(std::count(m_received.begin(), m_received.end(), interfered->GetUid()), 0, "Test Case #2.11: Signal on Air Not Replayed as Interference after Retuning");
+    
+    return;
+}
+
+/************************************************************************************/
+/*  Test Case #2.12: Channel Spatial Index Delivery    */
+class LoRaMeshRangeLossModel : public PropagationLossModel
+{
+private:
+    virtual double DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+    {
+        /*  LoRaPHYs without a position are always within range  */
+        if (a && b && a->GetDistanceFrom(b) > 500)
+        {
+            return -1000;
+        }
+        
+        return txPowerDbm - 3;
+    }
+    
+    virtual int64_t DoAssignStreams(int64_t stream)
+    {
+        return 0;
+    }
+};
+
+class LoRaMeshRangeDelayModel : public PropagationDelayModel
+{
+public:
+    virtual Time GetDelay(Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+    {
+        return MicroSeconds(1);
+    }
+    
+private:
+    virtual int64_t DoAssignStreams(int64_t stream)
+    {
+        return 0;
+    }
+};
+
+class LoRaMeshTestCase2_12 : public TestCase
+{
+public:
+    LoRaMeshTestCase2_12();
+    virtual ~LoRaMeshTestCase2_12();
+
+private:
+    virtual void DoRun(void);
+    
+    void PacketReceived(std::string context, Ptr<const Packet> packet);
+    std::set<std::string> SendPacket(bool spatial_index);
+    
+    std::set<std::string> m_received;
+};
+
+LoRaMeshTestCase2_12::LoRaMeshTestCase2_12()
+  : TestCase("LoRa Mesh Test Case #2.12: Channel Spatial Index Delivery")
+{
+}
+
+LoRaMeshTestCase2_12::~LoRaMeshTestCase2_12()
+{
+}
+
+void
+LoRaMeshTestCase2_12::PacketReceived(std::string context, Ptr<const Packet> packet)
+{
+    m_received.insert(context);
+    return;
+}
+
+std::set<std::string>
+LoRaMeshTestCase2_12::SendPacket(bool spatial_index)
+{
+    /*  in range, in range in a cell further away, out of range, in range in a negative cell, and without a position  */
+    const double positions[] = {100, 450, 900, -450};
+    
+    Ptr<LoRaChannel> channel = CreateObject<LoRaChannel>();
+    Ptr<LoRaPHY> sender = CreateObject<LoRaPHY>();
+    Ptr<LoRaPHY> receiver;
+    Ptr<MobilityModel> mobility;
+    
+    channel->SetAttribute("SpatialIndex", BooleanValue(spatial_index));
+    channel->SetAttribute("MaxRange", DoubleValue(500));
+    channel->SetAttribute("GridCellSize", DoubleValue(200));
+    channel->SetLossModel(CreateObject<LoRaMeshRangeLossModel>());
+    channel->SetDelayModel(CreateObject<LoRaMeshRangeDelayModel>());
+    
+    sender->SetMobility(CreateObject<ConstantPositionMobilityModel>());
+    sender->SetChannel(channel);
+    channel->AddPHY(sender);
+    
+    for (int i = 0; i < 5; i++)
+    {
+        receiver = CreateObject<LoRaPHY>();
+        
+        if (i < 4)
+        {
+            mobility = CreateObject<ConstantPositionMobilityModel>();
+            mobility->SetPosition(Vector3D(positions[i], 0, 0));
+            receiver->SetMobility(mobility);
+        }
+        
+        /*  the LoRaMAC is only there to take the received packets  */
+        receiver->SetMAC(CreateObject<LoRaMAC>());
+        receiver->SetRxFreq(868.1);
+        receiver->TraceConnect("RxSniffer", std::to_string(i), MakeCallback(&LoRaMeshTestCase2_12::PacketReceived, this));
+        receiver->SetChannel(channel);
+        channel->AddPHY(receiver);
+    }
+    
+    /*  addressed elsewhere so the receiving LoRaMACs neither answer nor forward it    */
+    Ptr<Packet> packet = Create<Packet>(25);
+    LoRaMeshHeader header;
+    header.SetType(DIRECTED);
+    header.SetSrc(98);
+    header.SetFwd(98);
+    header.SetDest(99);
+    packet->AddHeader(header);
+    
+    m_received.clear();
+    channel->Send(sender, packet, 14, 868.1, 7, Seconds(1));
+    
+    Simulator::Stop(Seconds(2));
+    Simulator::Run();
+    Simulator::Destroy();
+    
+    return m_received;
+}
+
+void
+LoRaMeshTestCase2_12::DoRun(void)
+{
+    std::set<std::string> scanned = SendPacket(false);
+    std::set<std::string> indexed = SendPacket(true);
+    
+    NS_TEST_ASSERT_MSG_EQ(scanned.size(), 4, "Test Case #2.12: Incorrect Number of Receivers with Full Scan");
+    NS_TEST_ASSERT_MSG_EQ((indexed == scanned), true, "Test Case #2.12: Spatial Index Delivers to Different Receivers than Full Scan");
+    NS_TEST_ASSERT_MSG_EQ(indexed.count("4"), 1, "Test Case #2.12: LoRaPHY without MobilityModel Skipped by Spatial Index");
+    
+    return;
+}
+
 /************************************************************************************/
 
 
@@ -171,6 +775,13 @@ LoRaMeshTestSuite_2::LoRaMeshTestSuite_2()
     AddTestCase(new LoRaMeshTestCase2_2, TestCase::QUICK);
     AddTestCase(new LoRaMeshTestCase2_3, TestCase::QUICK);
     AddTestCase(new LoRaMeshTestCase2_5, TestCase::QUICK);
+    AddTestCase(new LoRaMeshTestCase2_6, TestCase::QUICK);
+    AddTestCase(new LoRaMeshTestCase2_7, TestCase::QUICK);
+    AddTestCase(new LoRaMeshTestCase2_8, TestCase::QUICK);
+    AddTestCase(new LoRaMeshTestCase2_9, TestCase::QUICK);
+    AddTestCase(new LoRaMeshTestCase2_10, TestCase::QUICK);
+    AddTestCase(new LoRaMeshTestCase2_11, TestCase::QUICK);
+    AddTestCase(new LoRaMeshTestCase2_12, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
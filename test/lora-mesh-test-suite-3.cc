@@ -11,8 +11,11 @@
 #include "ns3/simulator.h"
 #include "ns3/callback.h"
 #include "ns3/application.h"
+#include "ns3/net-device-container.h"
 
 #include <iterator>
+#include <set>
+#include <vector>
 
 using namespace ns3;
 using namespace lora_mesh;
@@ -727,6 +730,854 @@ LoRaMeshTestCase3_7::DoRun(void)
     return;
 }
 
+/************************************************************************************/
+/*  Test Case #3.8: ETX Follows Routing Table Changes   */
+class LoRaMeshTestCase3_8 : public TestCase
+{
+public:
+    LoRaMeshTestCase3_8();
+    virtual ~LoRaMeshTestCase3_8();
+
+private:
+    virtual void DoRun(void);
+};
+
+LoRaMeshTestCase3_8::LoRaMeshTestCase3_8()
+  : TestCase("LoRa Mesh Test Case #3.8: ETX Follows Routing Table Changes")
+{
+}
+
+LoRaMeshTestCase3_8::~LoRaMeshTestCase3_8()
+{
+}
+
+void
+LoRaMeshTestCase3_8::DoRun(void)
+{
+    Ptr<LoRaMAC> mac = CreateObject<LoRaMAC>();
+    RoutingTableEntry entry;
+    
+    /*  1 -> 2 -> 3 and a direct, dearer 1 -> 3    */
+    entry = {1, 2, 2, 0};
+    mac->AddTableEntry(entry);
+    entry = {2, 3, 2, 0};
+    mac->AddTableEntry(entry);
+    entry = {1, 3, 5, 0};
+    mac->AddTableEntry(entry);
+    
+    NS_TEST_ASSERT_MSG_EQ(mac->CalcETX(1, 3), 4, "Test Case #3.8: Incorrect ETX for Shortest Path");
+    NS_TEST_ASSERT_MSG_EQ(mac->CalcETX(3, 1), 0, "Test Case #3.8: ETX Found for Unknown Path");
+    
+    /*  a dearer link on the cached path must reroute   */
+    entry = {2, 3, 8, 0};
+    mac->UpdateTableEntry(entry);
+    
+    NS_TEST_ASSERT_MSG_EQ(mac->CalcETX(1, 3), 5, "Test Case #3.8: ETX Not Updated for Dearer Link");
+    
+    /*  a cheaper link must be picked up    */
+    entry = {2, 3, 1, 0};
+    mac->UpdateTableEntry(entry);
+    
+    NS_TEST_ASSERT_MSG_EQ(mac->CalcETX(1, 3), 3, "Test Case #3.8: ETX Not Updated for Cheaper Link");
+    
+    mac->RemoveTableEntry(1, 2);
+    
+    NS_TEST_ASSERT_MSG_EQ(mac->CalcETX(1, 3), 5, "Test Case #3.8: ETX Not Updated for Removed Link");
+    
+    return;
+}
+
+/************************************************************************************/
+/*  Test Case #3.9: Routing Table Lookup after Removal  */
+class LoRaMeshTestCase3_9 : public TestCase
+{
+public:
+    LoRaMeshTestCase3_9();
+    virtual ~LoRaMeshTestCase3_9();
+
+private:
+    virtual void DoRun(void);
+};
+
+LoRaMeshTestCase3_9::LoRaMeshTestCase3_9()
+  : TestCase("LoRa Mesh Test Case #3.9: Routing Table Lookup after Removal")
+{
+}
+
+LoRaMeshTestCase3_9::~LoRaMeshTestCase3_9()
+{
+}
+
+void
+LoRaMeshTestCase3_9::DoRun(void)
+{
+    Ptr<LoRaMAC> mac = CreateObject<LoRaMAC>();
+    RoutingTableEntry entry;
+    uint32_t i;
+    
+    for (i = 1;i <= 10;i++)
+    {
+        entry = {i, i + 1, (float)i, 0};
+        mac->AddTableEntry(entry);
+    }
+    
+    /*  duplicates must not be added    */
+    entry = {1, 2, 7, 0};
+    mac->AddTableEntry(entry);
+    
+    NS_TEST_ASSERT_MSG_EQ(mac->GetTableSize(), 10, "Test Case #3.9: Incorrect Routing Table Size");
+    NS_TEST_ASSERT_MSG_EQ(mac->TableLookup(1, 2).etx, 1, "Test Case #3.9: Duplicate Entry Overwrote Existing");
+    
+    mac->RemoveTableEntry(3, 4);
+    
+    NS_TEST_ASSERT_MSG_EQ(mac->GetTableSize(), 9, "Test Case #3.9: Failed to Remove Entry");
+    NS_TEST_ASSERT_MSG_EQ(mac->EntryExists({3, 4, 0, 0}), false, "Test Case #3.9: Removed Entry Still Exists");
+    
+    /*  every remaining entry must still be found   */
+    for (i = 1;i <= 10;i++)
+    {
+        if (i != 3)
+        {
+            NS_TEST_ASSERT_MSG_EQ(mac->TableLookup(i, i + 1).etx, i, "Test Case #3.9: Entry Lost after Removal");
+        }
+    }
+    
+    return;
+}
+
+/************************************************************************************/
+/*  Test Case #3.10: Assigning Random Streams to MACs   */
+class LoRaMeshTestCase3_10 : public TestCase
+{
+public:
+    LoRaMeshTestCase3_10();
+    virtual ~LoRaMeshTestCase3_10();
+
+private:
+    virtual void DoRun(void);
+};
+
+LoRaMeshTestCase3_10::LoRaMeshTestCase3_10()
+  : TestCase("LoRa Mesh Test Case #3.10: Assigning Random Streams to MACs")
+{
+}
+
+LoRaMeshTestCase3_10::~LoRaMeshTestCase3_10()
+{
+}
+
+void
+LoRaMeshTestCase3_10::DoRun(void)
+{
+    NetDeviceContainer devices;
+    Ptr<LoRaNetDevice> device;
+    LoRaMacHelper helper;
+    
+    for (int i = 0;i < 3;i++)
+    {
+        device = Create<LoRaNetDevice>();
+        device->SetMAC(CreateObject<LoRaMAC>());
+        devices.Add(device);
+    }
+    
+    NS_TEST_ASSERT_MSG_EQ(helper.AssignStreams(devices, 10), 3, "Test Case #3.10: Incorrect Number of Streams Assigned");
+    
+    return;
+}
+
+/************************************************************************************/
+/*  Test Case #3.11: Compact Header Format   */
+class LoRaMeshTestCase3_11 : public TestCase
+{
+public:
+    LoRaMeshTestCase3_11();
+    virtual ~LoRaMeshTestCase3_11();
+
+private:
+    virtual void DoRun(void);
+};
+
+LoRaMeshTestCase3_11::LoRaMeshTestCase3_11()
+  : TestCase("LoRa Mesh Test Case #3.11: Compact Header Format")
+{
+}
+
+LoRaMeshTestCase3_11::~LoRaMeshTestCase3_11()
+{
+}
+
+void
+LoRaMeshTestCase3_11::DoRun(void)
+{
+    Ptr<Packet> packet = Create<Packet>(10);
+    LoRaMeshHeader header, received;
+    LoRaMeshRoutingHeader rheader, rreceived;
+    LoRaMeshFeedbackHeader fheader, freceived;
+    
+    header.SetType(ROUTING_UPDATE);
+    header.SetSrc(5);
+    header.SetDest(300);
+    header.SetFwd(70000);
+    header.SetCompact(true);
+    
+    /*  1 + 1 + 2 + 3   */
+    NS_TEST_ASSERT_MSG_EQ(header.GetSerializedSize(), 7, "Test Case #3.11: Failed Compact Header Size");
+    
+    rheader.SetETX(3);
+    rheader.SetLast(200);
+    rheader.SetCompact(true);
+    
+    packet->AddHeader(rheader);
+    packet->AddHeader(header);
+    
+    NS_TEST_ASSERT_MSG_EQ(packet->GetSize(), 19, "Test Case #3.11: Failed Compact Packet Size");
+    
+    packet->RemoveHeader(received);
+    rreceived.SetCompact(received.IsCompact());
+    packet->RemoveHeader(rreceived);
+    
+    NS_TEST_ASSERT_MSG_EQ(received.IsCompact(), true, "Test Case #3.11: Compact Format Not Detected");
+    NS_TEST_ASSERT_MSG_EQ(received.GetType(), ROUTING_UPDATE, "Test Case #3.11: Failed Type");
+    NS_TEST_ASSERT_MSG_EQ(received.GetSrc(), 5, "Test Case #3.11: Failed Source ID");
+    NS_TEST_ASSERT_MSG_EQ(received.GetDest(), 300, "Test Case #3.11: Failed Destination ID");
+    NS_TEST_ASSERT_MSG_EQ(received.GetFwd(), 70000, "Test Case #3.11: Failed Forwarding ID");
+    NS_TEST_ASSERT_MSG_EQ(rreceived.GetETX(), 3, "Test Case #3.11: Failed Quantized ETX");
+    NS_TEST_ASSERT_MSG_EQ(rreceived.GetLast(), 200, "Test Case #3.11: Failed Last Counter");
+    
+    /*  fixed format headers are still read with the same header   */
+    header.SetCompact(false);
+    header.SetType(FEEDBACK);
+    fheader.SetPacketId(0x12345);
+    
+    packet->AddHeader(fheader);
+    packet->AddHeader(header);
+    packet->RemoveHeader(received);
+    freceived.SetCompact(received.IsCompact());
+    packet->RemoveHeader(freceived);
+    
+    NS_TEST_ASSERT_MSG_EQ(received.IsCompact(), false, "Test Case #3.11: Fixed Format Not Detected");
+    NS_TEST_ASSERT_MSG_EQ(received.GetFwd(), 70000, "Test Case #3.11: Failed Fixed Forwarding ID");
+    NS_TEST_ASSERT_MSG_EQ(freceived.GetPacketId(), 0x12345, "Test Case #3.11: Failed Fixed Feedback ID");
+    
+    fheader.SetCompact(true);
+    packet->AddHeader(fheader);
+    freceived.SetCompact(true);
+    packet->RemoveHeader(freceived);
+    
+    NS_TEST_ASSERT_MSG_EQ(freceived.GetPacketId(), 0x2345, "Test Case #3.11: Failed Short Feedback ID");
+    
+    return;
+}
+
+/************************************************************************************/
+/*  Test Case #3.12: Multi-Entry Routing Updates    */
+class LoRaMeshTestCase3_12 : public TestCase
+{
+public:
+    LoRaMeshTestCase3_12();
+    virtual ~LoRaMeshTestCase3_12();
+
+private:
+    virtual void DoRun(void);
+};
+
+LoRaMeshTestCase3_12::LoRaMeshTestCase3_12()
+  : TestCase("LoRa Mesh Test Case #3.12: Multi-Entry Routing Updates")
+{
+}
+
+LoRaMeshTestCase3_12::~LoRaMeshTestCase3_12()
+{
+}
+
+void
+LoRaMeshTestCase3_12::DoRun(void)
+{
+    Ptr<LoRaMAC> mac = CreateObject<LoRaMAC>();
+    Ptr<Packet> packet = Create<Packet>(0);
+    LoRaMeshHeader header, received;
+    LoRaMeshRoutingListHeader lheader, lreceived;
+    RoutingListEntry entry;
+    
+    header.SetType(ROUTING_UPDATES);
+    header.SetSrc(7);
+    header.SetDest(7);
+    header.SetFwd(7);
+    header.SetCompact(true);
+    
+    lheader.SetLast(0);
+    lheader.SetCompact(true);
+    entry = {7, 7, 0};
+    lheader.AddEntry(entry);
+    entry = {7, 300, 2};
+    lheader.AddEntry(entry);
+    
+    /*  2 + (1 + 1 + 1) + (1 + 2 + 1)   */
+    NS_TEST_ASSERT_MSG_EQ(lheader.GetSerializedSize(), 9, "Test Case #3.12: Failed Compact List Size");
+    
+    packet->AddHeader(lheader);
+    packet->AddHeader(header);
+    packet->RemoveHeader(received);
+    lreceived.SetCompact(received.IsCompact());
+    packet->RemoveHeader(lreceived);
+    
+    NS_TEST_ASSERT_MSG_EQ(received.GetType(), ROUTING_UPDATES, "Test Case #3.12: Failed Type");
+    NS_TEST_ASSERT_MSG_EQ(lreceived.GetEntries().size(), 2, "Test Case #3.12: Failed Number of Entries");
+    NS_TEST_ASSERT_MSG_EQ(lreceived.GetEntries()[1].r, 300, "Test Case #3.12: Failed Entry Receiver ID");
+    NS_TEST_ASSERT_MSG_EQ(lreceived.GetEntries()[1].etx, 2, "Test Case #3.12: Failed Entry ETX");
+    
+    /*  every entry of the advertisement is applied (the MAC has no device so its ID is 0) */
+    packet->AddHeader(lreceived);
+    packet->AddHeader(received);
+    mac->Receive(packet);
+    
+    NS_TEST_ASSERT_MSG_EQ(mac->TableLookup(7, 0).etx, 1, "Test Case #3.12: Link Entry Not Added");
+    NS_TEST_ASSERT_MSG_EQ(mac->TableLookup(7, 300).etx, 2, "Test Case #3.12: Routing Entry Not Added");
+    
+    /*  the link is estimated once for the advertisement from the missed counter values */
+    lheader = LoRaMeshRoutingListHeader();
+    lheader.SetLast(2);
+    entry = {7, 300, 3};
+    lheader.AddEntry(entry);
+    entry = {7, 301, 4};
+    lheader.AddEntry(entry);
+    
+    packet = Create<Packet>(0);
+    packet->AddHeader(lheader);
+    header.SetCompact(false);
+    packet->AddHeader(header);
+    mac->Receive(packet);
+    
+    NS_TEST_ASSERT_MSG_EQ(mac->TableLookup(7, 300).etx, 3, "Test Case #3.12: Routing Entry Not Updated");
+    NS_TEST_ASSERT_MSG_EQ(mac->TableLookup(7, 301).etx, 4, "Test Case #3.12: Routing Entry Not Added");
+    NS_TEST_ASSERT_MSG_EQ(mac->TableLookup(7, 0).etx, 2, "Test Case #3.12: Link Estimate Not Updated");
+    NS_TEST_ASSERT_MSG_EQ(mac->TableLookup(7, 0).last, 2, "Test Case #3.12: Link Counter Not Updated");
+    
+    /*  an advertisement with only the entry of the forwarder itself still estimates the link  */
+    lheader = LoRaMeshRoutingListHeader();
+    lheader.SetLast(5);
+    entry = {7, 7, 0};
+    lheader.AddEntry(entry);
+    
+    packet = Create<Packet>(0);
+    packet->AddHeader(lheader);
+    packet->AddHeader(header);
+    mac->Receive(packet);
+    
+    NS_TEST_ASSERT_MSG_EQ(mac->TableLookup(7, 0).etx, 3, "Test Case #3.12: Link Not Estimated from Self Entry");
+    NS_TEST_ASSERT_MSG_EQ(mac->TableLookup(7, 0).last, 5, "Test Case #3.12: Link Counter Not Updated from Self Entry");
+    NS_TEST_ASSERT_MSG_EQ(mac->GetTableSize(), 3, "Test Case #3.12: Self Entry Added to Table");
+    
+    return;
+}
+
+/************************************************************************************/
+/*  Test Case #3.13: Trickle Timer Routing Updates   */
+class LoRaMeshTestCase3_13 : public TestCase
+{
+public:
+    LoRaMeshTestCase3_13();
+    virtual ~LoRaMeshTestCase3_13();
+
+private:
+    virtual void DoRun(void);
+    
+    /**
+     *  Runs two neighbouring nodes for four hours
+     * 
+     *  \param  trickle whether the Trickle timer is enabled
+     *  \param  late    whether the Trickle timer is only enabled after ten minutes, once the nodes
+     *                  are running, rather than when they are installed
+     * 
+     *  \return the number of routing updates sent
+     */
+    uint32_t RunNetwork(bool trickle, bool late);
+    
+    void MacEvent(const LoRaMacEvent &event);
+    
+    uint32_t m_routingUpdates;
+    uint32_t m_lateRoutingUpdates;
+    bool m_converged;
+};
+
+LoRaMeshTestCase3_13::LoRaMeshTestCase3_13()
+  : TestCase("LoRa Mesh Test Case #3.13: Trickle Timer Routing Updates")
+{
+}
+
+LoRaMeshTestCase3_13::~LoRaMeshTestCase3_13()
+{
+}
+
+void
+LoRaMeshTestCase3_13::MacEvent(const LoRaMacEvent &event)
+{
+    if (event.type == MAC_TX_ROUTING_UPDATE)
+    {
+        m_routingUpdates++;
+        
+        if (Simulator::Now() > Hours(1))
+        {
+            m_lateRoutingUpdates++;
+        }
+    }
+    
+    return;
+}
+
+uint32_t
+LoRaMeshTestCase3_13::RunNetwork(bool trickle, bool late)
+{
+    NodeContainer nodes;
+    NetDeviceContainer devices;
+    LoRaPhyHelper phy;
+    LoRaMacHelper mac;
+    LoRaMeshHelper helper;
+    Ptr<LoRaChannel> channel = CreateObject<LoRaChannel>();
+    
+    Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel>();
+    loss->SetPathLossExponent(3.76);
+    loss->SetReference(1, 7.7);
+    
+    channel->SetLossModel(loss);
+    channel->SetDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+    
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    
+    nodes.Create(2);
+    mobility.Install(nodes);
+    nodes.Get(1)->GetObject<MobilityModel>()->SetPosition(Vector3D(100, 0, 0));
+    
+    phy.SetChannel(channel);
+    mac.Set("TrickleEnabled", BooleanValue(trickle && !late));
+    devices = helper.Install(phy, mac, nodes);
+    helper.AssignStreams(devices, 0);
+    
+    m_routingUpdates = 0;
+    m_lateRoutingUpdates = 0;
+    
+    for (uint32_t i = 0;i < devices.GetN();i++)
+    {
+        Ptr<LoRaMAC> lora_mac = DynamicCast<LoRaNetDevice>(devices.Get(i))->GetMAC();
+        
+        lora_mac->TraceConnectWithoutContext("MacEvent", MakeCallback(&LoRaMeshTestCase3_13::MacEvent, this));
+        
+        if (trickle && late)
+        {
+            Simulator::Schedule(Minutes(10), &LoRaMAC::SetTrickleEnabled, lora_mac, true);
+        }
+    }
+    
+    Simulator::Stop(Hours(4));
+    Simulator::Run();
+    
+    Ptr<LoRaMAC> first = DynamicCast<LoRaNetDevice>(devices.Get(0))->GetMAC();
+    m_converged = first->EntryExists({nodes.Get(1)->GetId(), nodes.Get(0)->GetId(), 0, 0});
+    
+    Simulator::Destroy();
+    
+    return m_routingUpdates;
+}
+
+void
+LoRaMeshTestCase3_13::DoRun(void)
+{
+    uint32_t fixed = RunNetwork(false, false);
+    uint32_t fixed_late = m_lateRoutingUpdates;
+    
+    NS_TEST_ASSERT_MSG_EQ(m_converged, true, "Test Case #3.13: Link Not Found with Fixed Routing Updates");
+    
+    uint32_t trickle = RunNetwork(true, false);
+    
+    NS_TEST_ASSERT_MSG_EQ(m_converged, true, "Test Case #3.13: Link Not Found with Trickle Timer");
+    NS_TEST_ASSERT_MSG_GT(trickle, 0, "Test Case #3.13: No Routing Updates Sent with Trickle Timer");
+    NS_TEST_ASSERT_MSG_LT(trickle * 4, fixed, "Test Case #3.13: Trickle Timer Did Not Reduce Routing Updates");
+    
+    /*  enabled on running nodes, the timer must start and keep routing updates going */
+    RunNetwork(true, true);
+    
+    NS_TEST_ASSERT_MSG_EQ(m_converged, true, "Test Case #3.13: Link Not Found with Trickle Timer Enabled Late");
+    NS_TEST_ASSERT_MSG_GT(m_lateRoutingUpdates, 0, "Test Case #3.13: No Routing Updates Sent after Enabling Trickle Timer");
+    NS_TEST_ASSERT_MSG_LT(m_lateRoutingUpdates * 4, fixed_late, "Test Case #3.13: Late Trickle Timer Did Not Reduce Routing Updates");
+    
+    return;
+}
+
+/************************************************************************************/
+/*  Test Case #3.14: Aggregated Feedback Header   */
+class LoRaMeshTestCase3_14 : public TestCase
+{
+public:
+    LoRaMeshTestCase3_14();
+    virtual ~LoRaMeshTestCase3_14();
+
+private:
+    virtual void DoRun(void);
+};
+
+LoRaMeshTestCase3_14::LoRaMeshTestCase3_14()
+  : TestCase("LoRa Mesh Test Case #3.14: Aggregated Feedback Header")
+{
+}
+
+LoRaMeshTestCase3_14::~LoRaMeshTestCase3_14()
+{
+}
+
+void
+LoRaMeshTestCase3_14::DoRun(void)
+{
+    Ptr<Packet> packet = Create<Packet>(0);
+    LoRaMeshFeedbackListHeader fheader, freceived;
+    
+    /*  added out of order, sent in ascending order */
+    fheader.AddPacketId(0x10005);
+    fheader.AddPacketId(0x10002);
+    fheader.AddPacketId(0x10200);
+    
+    /*  1 + 8 + 1 + 2   */
+    NS_TEST_ASSERT_MSG_EQ(fheader.GetSerializedSize(), 12, "Test Case #3.14: Failed Fixed Size");
+    
+    packet->AddHeader(fheader);
+    packet->RemoveHeader(freceived);
+    
+    NS_TEST_ASSERT_MSG_EQ(freceived.GetPacketIds().size(), 3, "Test Case #3.14: Failed Number of Packet IDs");
+    NS_TEST_ASSERT_MSG_EQ(freceived.GetPacketIds()[0], 0x10002, "Test Case #3.14: Failed First Packet ID");
+    NS_TEST_ASSERT_MSG_EQ(freceived.GetPacketIds()[1], 0x10005, "Test Case #3.14: Failed Second Packet ID");
+    NS_TEST_ASSERT_MSG_EQ(freceived.GetPacketIds()[2], 0x10200, "Test Case #3.14: Failed Third Packet ID");
+    
+    /*  the low 16 bits wrap between the packet IDs in the compact format  */
+    fheader = LoRaMeshFeedbackListHeader();
+    fheader.SetCompact(true);
+    fheader.AddPacketId(0x1fffe);
+    fheader.AddPacketId(0x20003);
+    
+    /*  1 + 2 + 1   */
+    NS_TEST_ASSERT_MSG_EQ(fheader.GetSerializedSize(), 4, "Test Case #3.14: Failed Compact Size");
+    
+    packet->AddHeader(fheader);
+    freceived.SetCompact(true);
+    packet->RemoveHeader(freceived);
+    
+    NS_TEST_ASSERT_MSG_EQ(freceived.GetPacketIds()[0], 0xfffe, "Test Case #3.14: Failed Short First Packet ID");
+    NS_TEST_ASSERT_MSG_EQ(freceived.GetPacketIds()[1], 0x0003, "Test Case #3.14: Failed Short Wrapped Packet ID");
+    NS_TEST_ASSERT_MSG_EQ(packet->GetSize(), 0, "Test Case #3.14: Compact Header Not Fully Read");
+    
+    /*  differences are sent modulo 0x10000 in the compact format, however far apart the IDs are   */
+    fheader = LoRaMeshFeedbackListHeader();
+    fheader.SetCompact(true);
+    fheader.AddPacketId(0x10005);
+    fheader.AddPacketId(0x30007);
+    
+    /*  1 + 2 + 1   */
+    NS_TEST_ASSERT_MSG_EQ(fheader.GetSerializedSize(), 4, "Test Case #3.14: Failed Compact Size for Distant Packet IDs");
+    
+    packet->AddHeader(fheader);
+    packet->RemoveHeader(freceived);
+    
+    NS_TEST_ASSERT_MSG_EQ(freceived.GetPacketIds()[1], 0x0007, "Test Case #3.14: Failed Short Distant Packet ID");
+    NS_TEST_ASSERT_MSG_EQ(packet->GetSize(), 0, "Test Case #3.14: Compact Header for Distant Packet IDs Not Fully Read");
+    
+    return;
+}
+
+/************************************************************************************/
+/*  Test Case #3.15: Feedback Packets without Padding   */
+class LoRaMeshTestCase3_15 : public TestCase
+{
+public:
+    LoRaMeshTestCase3_15();
+    virtual ~LoRaMeshTestCase3_15();
+
+private:
+    virtual void DoRun(void);
+};
+
+LoRaMeshTestCase3_15::LoRaMeshTestCase3_15()
+  : TestCase("LoRa Mesh Test Case #3.15: Feedback Packets without Padding")
+{
+}
+
+LoRaMeshTestCase3_15::~LoRaMeshTestCase3_15()
+{
+}
+
+void
+LoRaMeshTestCase3_15::DoRun(void)
+{
+    Ptr<LoRaMAC> mac = CreateObject<LoRaMAC>();
+    Ptr<Packet> packet = Create<Packet>(10);
+    Ptr<Packet> feedback;
+    
+    /*  50 + 8 + 13 */
+    feedback = mac->MakeFeedback(packet, 3);
+    NS_TEST_ASSERT_MSG_EQ(feedback->GetSize(), 71, "Test Case #3.15: Failed Padded Feedback Size");
+    
+    /*  only the headers    */
+    mac->SetAttribute("FeedbackPadding", UintegerValue(0));
+    feedback = mac->MakeFeedback(packet, 3);
+    NS_TEST_ASSERT_MSG_EQ(feedback->GetSize(), 21, "Test Case #3.15: Failed Feedback Size without Padding");
+    
+    return;
+}
+
+/************************************************************************************/
+/*  Test Case #3.16: Aggregated Feedback Queueing   */
+class LoRaMeshTestCase3_16 : public TestCase
+{
+public:
+    LoRaMeshTestCase3_16();
+    virtual ~LoRaMeshTestCase3_16();
+
+private:
+    virtual void DoRun(void);
+    
+    void PacketSent(Ptr<const Packet> packet);
+    
+    std::vector<uint32_t>   m_feedbackSizes;
+    std::set<uint64_t>      m_directed;
+};
+
+LoRaMeshTestCase3_16::LoRaMeshTestCase3_16()
+  : TestCase("LoRa Mesh Test Case #3.16: Aggregated Feedback Queueing")
+{
+}
+
+LoRaMeshTestCase3_16::~LoRaMeshTestCase3_16()
+{
+}
+
+void
+LoRaMeshTestCase3_16::PacketSent(Ptr<const Packet> packet)
+{
+    Ptr<Packet> copy = packet->Copy();
+    LoRaMeshHeader header;
+    LoRaMeshFeedbackListHeader flheader;
+    
+    copy->RemoveHeader(header);
+    
+    if (header.GetType() == FEEDBACKS)
+    {
+        flheader.SetCompact(header.IsCompact());
+        copy->RemoveHeader(flheader);
+        m_feedbackSizes.push_back(flheader.GetPacketIds().size());
+    }
+    else if (header.GetType() == DIRECTED)
+    {
+        m_directed.insert(packet->GetUid());
+    }
+    
+    return;
+}
+
+void
+LoRaMeshTestCase3_16::DoRun(void)
+{
+    NodeContainer nodes;
+    NetDeviceContainer devices;
+    LoRaPhyHelper phy;
+    LoRaMacHelper mac;
+    LoRaMeshHelper helper;
+    Ptr<LoRaChannel> channel = CreateObject<LoRaChannel>();
+    
+    channel->SetLossModel(CreateObject<LogDistancePropagationLossModel>());
+    channel->SetDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+    
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    
+    nodes.Create(1);
+    mobility.Install(nodes);
+    
+    phy.SetChannel(channel);
+    mac.Set("AggregateFeedback", BooleanValue(true));
+    mac.Set("MaxAggregatedFeedback", UintegerValue(2));
+    devices = helper.Install(phy, mac, nodes);
+    helper.AssignStreams(devices, 0);
+    
+    Ptr<LoRaMAC> lora_mac = DynamicCast<LoRaNetDevice>(devices.Get(0))->GetMAC();
+    uint32_t id = lora_mac->GetId();
+    
+    lora_mac->GetPHY()->TraceConnectWithoutContext("TxSniffer", MakeCallback(&LoRaMeshTestCase3_16::PacketSent, this));
+    
+    /*  the first two packet IDs share a feedback packet, the third rolls over to a new one    */
+    for (int i = 0;i < 3;i++)
+    {
+        lora_mac->QueueFeedback(Create<Packet>(10), 5);
+    }
+    
+    /*  two data packets, of which the first is acknowledged before it is sent  */
+    RoutingTableEntry entry = {id, 5, 1, 0};
+    lora_mac->AddTableEntry(entry);
+    
+    Ptr<Packet> acked = Create<Packet>(10);
+    Ptr<Packet> unacked = Create<Packet>(10);
+    
+    lora_mac->SendTo(acked, 5);
+    lora_mac->SendTo(unacked, 5);
+    
+    Ptr<Packet> feedback = Create<Packet>(0);
+    LoRaMeshHeader header;
+    LoRaMeshFeedbackListHeader flheader;
+    
+    flheader.AddPacketId(acked->GetUid());
+    feedback->AddHeader(flheader);
+    header.SetType(FEEDBACKS);
+    header.SetSrc(5);
+    header.SetDest(id);
+    header.SetFwd(5);
+    feedback->AddHeader(header);
+    
+    lora_mac->Receive(feedback);
+    
+    Simulator::Stop(Hours(1));
+    Simulator::Run();
+    Simulator::Destroy();
+    
+    NS_TEST_ASSERT_MSG_EQ(m_feedbackSizes.size(), 2, "Test Case #3.16: Incorrect Number of Feedback Packets");
+    
+    if (m_feedbackSizes.size() == 2)
+    {
+        NS_TEST_ASSERT_MSG_EQ(m_feedbackSizes[0], 2, "Test Case #3.16: Packet IDs Not Aggregated");
+        NS_TEST_ASSERT_MSG_EQ(m_feedbackSizes[1], 1, "Test Case #3.16: Full Feedback Packet Not Rolled Over");
+    }
+    
+    NS_TEST_ASSERT_MSG_EQ(m_directed.count(acked->GetUid()), 0, "Test Case #3.16: Acknowledged Packet Not Removed from Queue");
+    NS_TEST_ASSERT_MSG_EQ(m_directed.count(unacked->GetUid()), 1, "Test Case #3.16: Unacknowledged Packet Not Sent");
+    
+    return;
+}
+
+/************************************************************************************/
+/*  Test Case #3.17: Feedback with Compact Headers   */
+class LoRaMeshTestCase3_17 : public TestCase
+{
+public:
+    LoRaMeshTestCase3_17();
+    virtual ~LoRaMeshTestCase3_17();
+
+private:
+    virtual void DoRun(void);
+    
+    void SenderSent(Ptr<const Packet> packet);
+    void ReceiverSent(Ptr<const Packet> packet);
+    
+    uint64_t    m_uid;
+    uint32_t    m_dataSent;
+    uint32_t    m_feedbackSent;
+    bool        m_compact;
+};
+
+LoRaMeshTestCase3_17::LoRaMeshTestCase3_17()
+  : TestCase("LoRa Mesh Test Case #3.17: Feedback with Compact Headers")
+{
+}
+
+LoRaMeshTestCase3_17::~LoRaMeshTestCase3_17()
+{
+}
+
+void
+LoRaMeshTestCase3_17::SenderSent(Ptr<const Packet> packet)
+{
+    LoRaMeshHeader header;
+    
+    packet->PeekHeader(header);
+    
+    if (header.GetType() == DIRECTED && packet->GetUid() == m_uid)
+    {
+        m_dataSent++;
+        m_compact = m_compact && header.IsCompact();
+    }
+    
+    return;
+}
+
+void
+LoRaMeshTestCase3_17::ReceiverSent(Ptr<const Packet> packet)
+{
+    LoRaMeshHeader header;
+    
+    packet->PeekHeader(header);
+    
+    if (header.GetType() == FEEDBACK || header.GetType() == FEEDBACKS)
+    {
+        m_feedbackSent++;
+        m_compact = m_compact && header.IsCompact();
+    }
+    
+    return;
+}
+
+void
+LoRaMeshTestCase3_17::DoRun(void)
+{
+    NodeContainer nodes;
+    NetDeviceContainer devices;
+    LoRaPhyHelper phy;
+    LoRaMacHelper mac;
+    LoRaMeshHelper helper;
+    Ptr<LoRaChannel> channel = CreateObject<LoRaChannel>();
+    
+    Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel>();
+    loss->SetPathLossExponent(3.76);
+    loss->SetReference(1, 7.7);
+    
+    channel->SetLossModel(loss);
+    channel->SetDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+    
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    
+    nodes.Create(2);
+    mobility.Install(nodes);
+    nodes.Get(1)->GetObject<MobilityModel>()->SetPosition(Vector3D(100, 0, 0));
+    
+    phy.SetChannel(channel);
+    mac.Set("CompactHeaders", BooleanValue(true));
+    devices = helper.Install(phy, mac, nodes);
+    helper.AssignStreams(devices, 0);
+    
+    Ptr<LoRaMAC> sender = DynamicCast<LoRaNetDevice>(devices.Get(0))->GetMAC();
+    Ptr<LoRaMAC> receiver = DynamicCast<LoRaNetDevice>(devices.Get(1))->GetMAC();
+    
+    sender->GetPHY()->TraceConnectWithoutContext("TxSniffer", MakeCallback(&LoRaMeshTestCase3_17::SenderSent, this));
+    receiver->GetPHY()->TraceConnectWithoutContext("TxSniffer", MakeCallback(&LoRaMeshTestCase3_17::ReceiverSent, this));
+    
+    /*  give the sender a route so the packet goes out in its first packet timeslot    */
+    RoutingTableEntry entry = {sender->GetId(), receiver->GetId(), 1, 0};
+    sender->AddTableEntry(entry);
+    
+    /*  sent through the device so that LoRaMAC::Send re-encodes the header  */
+    Ptr<Packet> packet = Create<Packet>(50);
+    LoRaMeshHeader header;
+    header.SetType(DIRECTED);
+    header.SetSrc(sender->GetId());
+    header.SetFwd(sender->GetId());
+    header.SetDest(receiver->GetId());
+    packet->AddHeader(header);
+    
+    m_uid = packet->GetUid();
+    m_dataSent = 0;
+    m_feedbackSent = 0;
+    m_compact = true;
+    
+    devices.Get(0)->Send(packet, Address(), 0);
+    
+    /*  long enough for all ten sends of a packet which is never acknowledged   */
+    Simulator::Stop(Hours(1));
+    Simulator::Run();
+    Simulator::Destroy();
+    
+    NS_TEST_ASSERT_MSG_GT(m_dataSent, 0, "Test Case #3.17: Packet Not Sent");
+    NS_TEST_ASSERT_MSG_GT(m_feedbackSent, 0, "Test Case #3.17: Feedback Not Sent");
+    NS_TEST_ASSERT_MSG_LT(m_dataSent, 10, "Test Case #3.17: Packet Not Removed from Queue by Compact Feedback");
+    NS_TEST_ASSERT_MSG_EQ(m_compact, true, "Test Case #3.17: Fixed Format Header Sent");
+    
+    return;
+}
+
 /************************************************************************************/
 
 
@@ -752,6 +1603,16 @@ LoRaMeshTestSuite_3::LoRaMeshTestSuite_3()
     AddTestCase(new LoRaMeshTestCase3_5, TestCase::EXTENSIVE);
     AddTestCase(new LoRaMeshTestCase3_6, TestCase::QUICK);
     AddTestCase(new LoRaMeshTestCase3_7, TestCase::EXTENSIVE);
+    AddTestCase(new LoRaMeshTestCase3_8, TestCase::QUICK);
+    AddTestCase(new LoRaMeshTestCase3_9, TestCase::QUICK);
+    AddTestCase(new LoRaMeshTestCase3_10, TestCase::QUICK);
+    AddTestCase(new LoRaMeshTestCase3_11, TestCase::QUICK);
+    AddTestCase(new LoRaMeshTestCase3_12, TestCase::QUICK);
+    AddTestCase(new LoRaMeshTestCase3_13, TestCase::QUICK);
+    AddTestCase(new LoRaMeshTestCase3_14, TestCase::QUICK);
+    AddTestCase(new LoRaMeshTestCase3_15, TestCase::QUICK);
+    AddTestCase(new LoRaMeshTestCase3_16, TestCase::QUICK);
+    AddTestCase(new LoRaMeshTestCase3_17, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
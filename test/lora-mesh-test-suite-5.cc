@@ -13,6 +13,9 @@
 #include "ns3/application.h"
 
 #include <iterator>
+#include <fstream>
+#include <sstream>
+#include <cmath>
 
 using namespace ns3;
 using namespace lora_mesh;
@@ -457,15 +460,22 @@ LoRaMeshTestCase5_5::DoRun(void)
     AsciiHelperForLoRa ascii;
     ascii.EnableAscii("Test5_5_", nodes);
     
+    uint32_t src = nodes.Get(0)->GetId();
+    uint32_t dest = nodes.Get(1)->GetId();
+    
+    /*  give the sender a route so the packets go out from its first packet timeslot  */
+    RoutingTableEntry entry = {src, dest, 1, 0};
+    nodes.Get(0)->GetDevice(0)->GetObject<LoRaNetDevice>()->GetMAC()->AddTableEntry(entry);
+    
     for (unsigned int i = 0;i < 10;i++)
     {
         /*  make packet to send */
         Ptr<Packet> packet = Create<Packet>(50);
         LoRaMeshHeader header;
         header.SetType(DIRECTED);
-        header.SetSrc(nodes.Get(0)->GetId());
-        header.SetFwd(nodes.Get(0)->GetId());
-        header.SetDest(nodes.Get(1)->GetId());
+        header.SetSrc(src);
+        header.SetFwd(src);
+        header.SetDest(dest);
         packet->AddHeader(header);
         
         nodes.Get(0)->GetDevice(0)->Send(packet, Address(), 0);
@@ -473,8 +483,244 @@ LoRaMeshTestCase5_5::DoRun(void)
     
     Simulator::Stop(Minutes(10));
     Simulator::Run();
+    
+    uint64_t sent = ascii.GetFlowSent(src, dest);
+    uint64_t received = ascii.GetFlowReceived(src, dest);
+    
+    NS_TEST_ASSERT_MSG_GT(sent, 0, "Test Case #5.5: No Packets Counted as Sent");
+    NS_TEST_ASSERT_MSG_LT(sent, 11, "Test Case #5.5: Retransmissions Counted as Sent");
+    NS_TEST_ASSERT_MSG_LT(received, sent + 1, "Test Case #5.5: More Packets Received than Sent");
+    NS_TEST_ASSERT_MSG_EQ(ascii.GetFlowSent(dest, src), 0, "Test Case #5.5: Packets Counted on Reverse Flow");
+    
+    /*  pdr.tr is written when the simulator is destroyed  */
+    Simulator::Destroy();
+    
+    std::ifstream file("pdr.tr");
+    std::ostringstream flow;
+    std::string line;
+    bool found = false;
+    
+    flow << "Flow " << src << "->" << dest << ": Sent = " << sent << ", Received = " << received << ",";
+    
+    while (std::getline(file, line))
+    {
+        if (line.compare(0, flow.str().size(), flow.str()) == 0)
+        {
+            found = true;
+        }
+    }
+    
+    NS_TEST_ASSERT_MSG_EQ(found, true, "Test Case #5.5: Flow Counts Not Written to pdr.tr");
+    
+    return;
+}
+
+/************************************************************************************/
+/*  Test Case #5.6: Asynchronous Trace Writer Ring Buffer   */
+class LoRaMeshTestCase5_6 : public TestCase
+{
+public:
+    LoRaMeshTestCase5_6();
+    virtual ~LoRaMeshTestCase5_6();
+
+private:
+    virtual void DoRun(void);
+};
+
+LoRaMeshTestCase5_6::LoRaMeshTestCase5_6()
+  : TestCase("LoRa Mesh Test Case #5.6: Asynchronous Trace Writer Ring Buffer")
+{
+}
+
+LoRaMeshTestCase5_6::~LoRaMeshTestCase5_6()
+{
+}
+
+void
+LoRaMeshTestCase5_6::DoRun(void)
+{
+    std::string filename = "Test5_6.bin";
+    Ptr<AsyncTraceWriter> writer = Create<AsyncTraceWriter>(filename, AsyncTraceWriter::BINARY, 4);
+    LoRaTraceRecord record = {};
+    uint32_t i;
+    
+    /*  many times the capacity of the ring buffer so the producer has to wait for the writer  */
+    for (i = 0;i < 1000;i++)
+    {
+        record.time_ns = i * 1000;
+        record.uid = i;
+        record.node = i % 7;
+        record.event = LORA_TRACE_TX;
+        writer->Push(record);
+    }
+    
+    writer->Close();
+    
+    std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+    LoRaTraceFileHeader header;
+    
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    
+    NS_TEST_ASSERT_MSG_EQ(header.magic, (uint32_t)LORA_TRACE_MAGIC, "Test Case #5.6: Incorrect File Magic");
+    NS_TEST_ASSERT_MSG_EQ(header.record_size, sizeof(LoRaTraceRecord), "Test Case #5.6: Incorrect Record Size");
+    
+    for (i = 0;file.read(reinterpret_cast<char *>(&record), sizeof(record));i++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(record.uid, i, "Test Case #5.6: Records Lost or Reordered");
+        NS_TEST_ASSERT_MSG_EQ(record.time_ns, i * 1000, "Test Case #5.6: Incorrect Record Time");
+        NS_TEST_ASSERT_MSG_EQ(record.node, i % 7, "Test Case #5.6: Incorrect Record Node");
+    }
+    
+    NS_TEST_ASSERT_MSG_EQ(i, 1000, "Test Case #5.6: Incorrect Number of Records");
+    
+    return;
+}
+
+/************************************************************************************/
+/*  Test Case #5.7: Binary Tracing  */
+class LoRaMeshTestCase5_7 : public TestCase
+{
+public:
+    LoRaMeshTestCase5_7();
+    virtual ~LoRaMeshTestCase5_7();
+
+private:
+    virtual void DoRun(void);
+};
+
+LoRaMeshTestCase5_7::LoRaMeshTestCase5_7()
+  : TestCase("LoRa Mesh Test Case #5.7: Binary Tracing")
+{
+}
+
+LoRaMeshTestCase5_7::~LoRaMeshTestCase5_7()
+{
+}
+
+void
+LoRaMeshTestCase5_7::DoRun(void)
+{
+    NodeContainer nodes;
+    NetDeviceContainer devices;
+    Ptr<LoRaPHY> phy;
+    Ptr<LoRaMAC> mac;
+    Ptr<LoRaNetDevice> device;
+    Ptr<LoRaChannel> channel = CreateObject<LoRaChannel>();
+    
+    Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel>();
+    loss->SetPathLossExponent(3.76);
+    loss->SetReference(1, 7.7);
+    
+    Ptr<PropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel>();
+    
+    channel->SetLossModel(loss);
+    channel->SetDelayModel(delay);
+    
+    MobilityHelper mobility;
+    
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    
+    nodes.Create(2);
+    mobility.Install(nodes);
+    
+    for (NodeContainer::Iterator i = nodes.Begin();i != nodes.End();++i)
+    {
+        Ptr<Node> node = *i;
+        device = Create<LoRaNetDevice>();
+        phy = CreateObject<LoRaPHY>();
+        mac = CreateObject<LoRaMAC>();
+        
+        phy->SetNetDevice(device);
+        phy->SetMAC(mac);
+        phy->SetChannel(channel);
+        channel->AddPHY(phy);
+        device->SetMAC(mac);
+        device->SetPHY(phy);
+        device->SetNode(node);
+        node->AddDevice(device);
+        mac->SetPHY(phy);
+        mac->SetDevice(device);
+        devices.Add(device);
+    }
+    
+    nodes.Get(0)->GetObject<MobilityModel>()->SetPosition(Vector3D(10, 0, 0));
+    
+    uint32_t src = nodes.Get(0)->GetId();
+    uint32_t dest = nodes.Get(1)->GetId();
+    
+    /*  give the sender a route so the packet goes out in its first packet timeslot    */
+    RoutingTableEntry entry = {src, dest, 1, 0};
+    devices.Get(0)->GetObject<LoRaNetDevice>()->GetMAC()->AddTableEntry(entry);
+    
+    std::string filename = "Test5_7.bin";
+    BinaryTraceHelperForLoRa binary(filename);
+    binary.EnableBinary(devices);
+    
+    /*  make packet to send */
+    Ptr<Packet> packet = Create<Packet>(50);
+    LoRaMeshHeader header;
+    header.SetType(DIRECTED);
+    header.SetSrc(src);
+    header.SetFwd(src);
+    header.SetDest(dest);
+    packet->AddHeader(header);
+    
+    uint64_t uid = packet->GetUid();
+    uint32_t size = packet->GetSize();
+    
+    nodes.Get(0)->GetDevice(0)->Send(packet, Address(), 0);
+    
+    Simulator::Stop(Minutes(3));
+    Simulator::Run();
     Simulator::Destroy();
     
+    binary.Close();
+    
+    /*  read the trace back */
+    std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+    LoRaTraceFileHeader fheader;
+    LoRaTraceRecord record;
+    uint64_t n = 0;
+    uint32_t tx = 0;
+    
+    file.read(reinterpret_cast<char *>(&fheader), sizeof(fheader));
+    
+    NS_TEST_ASSERT_MSG_EQ(fheader.magic, (uint32_t)LORA_TRACE_MAGIC, "Test Case #5.7: Incorrect File Magic");
+    NS_TEST_ASSERT_MSG_EQ(fheader.version, (uint32_t)LORA_TRACE_VERSION, "Test Case #5.7: Incorrect File Version");
+    NS_TEST_ASSERT_MSG_EQ(fheader.record_size, sizeof(LoRaTraceRecord), "Test Case #5.7: Incorrect Record Size");
+    
+    while (file.read(reinterpret_cast<char *>(&record), sizeof(record)))
+    {
+        n++;
+        
+        if (record.uid != uid)
+        {
+            continue;
+        }
+        
+        NS_TEST_ASSERT_MSG_EQ(record.src, src, "Test Case #5.7: Incorrect Record Source");
+        NS_TEST_ASSERT_MSG_EQ(record.dest, dest, "Test Case #5.7: Incorrect Record Destination");
+        NS_TEST_ASSERT_MSG_EQ(record.type, (uint8_t)DIRECTED, "Test Case #5.7: Incorrect Record Type");
+        NS_TEST_ASSERT_MSG_EQ(record.size, size, "Test Case #5.7: Incorrect Record Size");
+        
+        if (record.event == LORA_TRACE_TX)
+        {
+            tx++;
+            
+            NS_TEST_ASSERT_MSG_EQ(record.node, src, "Test Case #5.7: Transmission Recorded at Wrong Node");
+            NS_TEST_ASSERT_MSG_EQ(record.x, 10, "Test Case #5.7: Incorrect Record Position");
+            NS_TEST_ASSERT_MSG_EQ(std::isnan(record.rx_power_dBm), true, "Test Case #5.7: Received Power Recorded for Transmission");
+        }
+        else
+        {
+            NS_TEST_ASSERT_MSG_EQ(record.node, dest, "Test Case #5.7: Reception Recorded at Wrong Node");
+            NS_TEST_ASSERT_MSG_EQ(std::isnan(record.rx_power_dBm), false, "Test Case #5.7: Received Power Not Recorded");
+        }
+    }
+    
+    NS_TEST_ASSERT_MSG_EQ(n, binary.GetNRecords(), "Test Case #5.7: Incorrect Number of Records");
+    NS_TEST_ASSERT_MSG_GT(tx, 0, "Test Case #5.7: Transmission Not Recorded");
+    
     return;
 }
 
@@ -502,7 +748,9 @@ LoRaMeshTestSuite_5::LoRaMeshTestSuite_5()
     AddTestCase(new LoRaMeshTestCase5_2, TestCase::TAKES_FOREVER);
     AddTestCase(new LoRaMeshTestCase5_3, TestCase::TAKES_FOREVER);
 //     AddTestCase(new LoRaMeshTestCase5_4, TestCase::TAKES_FOREVER);
-//     AddTestCase(new LoRaMeshTestCase5_5, TestCase::TAKES_FOREVER);
+    AddTestCase(new LoRaMeshTestCase5_5, TestCase::TAKES_FOREVER);
+    AddTestCase(new LoRaMeshTestCase5_6, TestCase::QUICK);
+    AddTestCase(new LoRaMeshTestCase5_7, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite